@@ -0,0 +1,208 @@
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include "BandLimitedBuffer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+BandLimitedBuffer::BandLimitedBuffer(unsigned int sampleRate, double clockRate, unsigned int maxFrameSamples) {
+    baseSamplesPerClock = (uint64_t)std::llround((double)sampleRate / clockRate * ((uint64_t)1 << BLEP_POSITION_FRACTION_BITS));
+    samplesPerClock = baseSamplesPerClock;
+
+    // Leave room for the tail of the kernel after the last available sample
+    buffer.resize(maxFrameSamples + BLEP_KERNEL_WIDTH + 1);
+
+    generateKernel();
+    clear();
+}
+
+void BandLimitedBuffer::clear() {
+    std::fill(buffer.begin(), buffer.end(), 0);
+    frameStartOffset = 0;
+    samplesAvailable = 0;
+    integrator = 0;
+}
+
+/**
+ * Builds a table of band-limited impulses (Blackman windowed sinc), one for each fractional sample position that a
+ * change can happen at. Integrating one of these produces a band-limited step.
+ */
+void BandLimitedBuffer::generateKernel() {
+    const double pi = 3.14159265358979323846;
+
+    // Cutoff as a fraction of the sample rate, slightly below nyquist so that the transition band doesn't alias
+    const double cutoff = 0.45;
+    const double halfWidth = BLEP_KERNEL_WIDTH / 2.0;
+    const int unit = 1 << BLEP_KERNEL_UNIT_BITS;
+
+    for (int phase = 0; phase < BLEP_KERNEL_PHASES; phase++) {
+        double fraction = (double)phase / BLEP_KERNEL_PHASES;
+        double values[BLEP_KERNEL_WIDTH];
+        double total = 0;
+
+        for (int tap = 0; tap < BLEP_KERNEL_WIDTH; tap++) {
+            // Distance of this tap from the centre of the impulse
+            double x = (tap - (halfWidth - 1)) - fraction;
+
+            double sinc = x == 0 ? 1.0 : std::sin(2 * pi * cutoff * x) / (2 * pi * cutoff * x);
+            double window = 0.42 + 0.5 * std::cos(pi * x / halfWidth) + 0.08 * std::cos(2 * pi * x / halfWidth);
+
+            values[tap] = sinc * window;
+            total += values[tap];
+        }
+
+        // Normalise each phase so that its taps add up to exactly one unit, otherwise every step would leave a small DC error behind
+        int sum = 0;
+        int largestTap = 0;
+
+        for (int tap = 0; tap < BLEP_KERNEL_WIDTH; tap++) {
+            kernel[phase][tap] = (short)std::lround(values[tap] / total * unit);
+            sum += kernel[phase][tap];
+
+            if (kernel[phase][tap] > kernel[phase][largestTap]) {
+                largestTap = tap;
+            }
+        }
+
+        kernel[phase][largestTap] += unit - sum;
+    }
+}
+
+void BandLimitedBuffer::addDelta(unsigned int time, int delta) {
+    if (delta == 0) {
+        return;
+    }
+
+    // Deltas are multiplied as 16-bit values
+    delta = std::max(-32768, std::min(delta, 32767));
+
+    uint64_t position = frameStartOffset + (time * samplesPerClock);
+
+    auto sampleIndex = (unsigned int)(position >> BLEP_POSITION_FRACTION_BITS);
+
+    // The top bits of the fraction select the kernel phase
+    auto phase = (unsigned int)((position & 0xFFFFFFFF) * BLEP_KERNEL_PHASES >> BLEP_POSITION_FRACTION_BITS);
+
+    if (sampleIndex + BLEP_KERNEL_WIDTH > buffer.size()) {
+        // More time has passed than the buffer was sized for - this shouldn't happen if the frames are kept short enough
+        return;
+    }
+
+    const short *phaseKernel = kernel[phase];
+    int *output = &buffer[sampleIndex];
+
+#if defined(__SSE2__)
+    // Multiply eight 16-bit taps at a time, then widen the products to 32 bits and add them to the buffer
+    __m128i deltas = _mm_set1_epi16((short)delta);
+
+    for (int tap = 0; tap < BLEP_KERNEL_WIDTH; tap += 8) {
+        __m128i taps = _mm_load_si128((const __m128i *)(phaseKernel + tap));
+        __m128i productsLow = _mm_mullo_epi16(taps, deltas);
+        __m128i productsHigh = _mm_mulhi_epi16(taps, deltas);
+
+        __m128i *destination = (__m128i *)(output + tap);
+        _mm_storeu_si128(destination, _mm_add_epi32(_mm_loadu_si128(destination), _mm_unpacklo_epi16(productsLow, productsHigh)));
+        _mm_storeu_si128(destination + 1, _mm_add_epi32(_mm_loadu_si128(destination + 1), _mm_unpackhi_epi16(productsLow, productsHigh)));
+    }
+#elif defined(__ARM_NEON)
+    int16x4_t deltas = vdup_n_s16((short)delta);
+
+    for (int tap = 0; tap < BLEP_KERNEL_WIDTH; tap += 4) {
+        vst1q_s32(output + tap, vmlal_s16(vld1q_s32(output + tap), vld1_s16(phaseKernel + tap), deltas));
+    }
+#else
+    for (int tap = 0; tap < BLEP_KERNEL_WIDTH; tap++) {
+        output[tap] += phaseKernel[tap] * delta;
+    }
+#endif
+}
+
+void BandLimitedBuffer::endFrame(unsigned int time) {
+    frameStartOffset += time * samplesPerClock;
+
+    samplesAvailable = std::min((unsigned int)(frameStartOffset >> BLEP_POSITION_FRACTION_BITS), (unsigned int)(buffer.size() - BLEP_KERNEL_WIDTH - 1));
+}
+
+unsigned int BandLimitedBuffer::getClocksForSamples(unsigned int samples) {
+    return (unsigned int)(((uint64_t)samples << BLEP_POSITION_FRACTION_BITS) / baseSamplesPerClock);
+}
+
+void BandLimitedBuffer::setRateAdjustment(double adjustment) {
+    // Only worked out once per frame, so the per-change work stays in integers
+    samplesPerClock = (uint64_t)std::llround((double)baseSamplesPerClock * adjustment);
+}
+
+unsigned int BandLimitedBuffer::getSamplesAvailable() {
+    return samplesAvailable;
+}
+
+unsigned int BandLimitedBuffer::readSamples(int16_t *output, unsigned int count) {
+    count = std::min(count, samplesAvailable);
+
+    for (unsigned int i = 0; i < count; i++) {
+        int sample = integrator >> BLEP_KERNEL_UNIT_BITS;
+
+        integrator += buffer[i];
+
+        if (sample > 32767) {
+            sample = 32767;
+        } else if (sample < -32768) {
+            sample = -32768;
+        }
+
+        output[i] = (int16_t)sample;
+
+        // Let the integrator leak slightly, which acts as a high-pass filter and removes any DC offset from the output
+        integrator -= sample * (1 << (BLEP_KERNEL_UNIT_BITS - BLEP_HIGHPASS_SHIFT));
+    }
+
+    // Move the samples which haven't been read yet (and the kernel tails) to the start of the buffer
+    std::copy(buffer.begin() + count, buffer.end(), buffer.begin());
+    std::fill(buffer.end() - count, buffer.end(), 0);
+
+    samplesAvailable -= count;
+    frameStartOffset -= (uint64_t)count << BLEP_POSITION_FRACTION_BITS;
+
+    return count;
+}
+
+double BandLimitedBuffer::benchmark(unsigned int sampleRate, double clockRate) {
+    const unsigned int seconds = 10;
+    const unsigned int framesPerSecond = 60;
+    const auto frameLength = (unsigned int)(clockRate / framesPerSecond);
+
+    // Tone periods (in clocks) and amplitudes for four channels, high enough to be far busier than a typical game
+    const unsigned int periods[4] = {1021, 1543, 2099, 587};
+    const int amplitudes[4] = {8000, 6400, 5120, 4096};
+
+    BandLimitedBuffer synth(sampleRate, clockRate, (unsigned int)(sampleRate / framesPerSecond) * 2);
+    std::vector<int16_t> output(sampleRate / framesPerSecond * 2);
+
+    unsigned int nextTransitions[4] = {0, 0, 0, 0};
+    int polarities[4] = {1, 1, 1, 1};
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int frame = 0; frame < seconds * framesPerSecond; frame++) {
+        for (int channel = 0; channel < 4; channel++) {
+            while (nextTransitions[channel] < frameLength) {
+                polarities[channel] = -polarities[channel];
+                synth.addDelta(nextTransitions[channel], amplitudes[channel] * 2 * polarities[channel]);
+                nextTransitions[channel] += periods[channel];
+            }
+
+            nextTransitions[channel] -= frameLength;
+        }
+
+        synth.endFrame(frameLength);
+        synth.readSamples(output.data(), (unsigned int)output.size());
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / seconds;
+}
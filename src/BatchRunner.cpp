@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include "BatchRunner.h"
+#include "MasterSystem.h"
+#include "InputMovie.h"
+
+BatchRunner::BatchRunner(unsigned int threadCount) : pool(threadCount) {
+
+}
+
+unsigned int BatchRunner::getThreadCount() {
+    return pool.getThreadCount();
+}
+
+std::vector<BatchJob> BatchRunner::readManifest(const std::string &fileName) {
+    json manifest = JsonHandler::parseJsonFile(fileName);
+
+    if (!manifest.is_array()) {
+        throw JSONParserException(Utils::implodeString({"Batch manifest '", fileName, "' must be an array of jobs"}));
+    }
+
+    std::vector<BatchJob> jobs;
+
+    for (auto &entry : manifest) {
+        BatchJob job = {JsonHandler::getString(entry, "rom"), 0, ""};
+
+        if (JsonHandler::keyExists(entry, "frames")) {
+            int frames = JsonHandler::getInteger(entry, "frames");
+
+            if (frames < 1) {
+                throw JSONParserException(Utils::implodeString({"Batch job for '", job.romFileName, "' must run at least one frame"}));
+            }
+
+            job.frames = (unsigned long)frames;
+        }
+
+        if (JsonHandler::keyExists(entry, "input")) {
+            job.inputFileName = JsonHandler::getString(entry, "input");
+        }
+
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+unsigned int BatchRunner::run(const std::vector<BatchJob> &jobs, std::ostream &output) {
+    std::atomic<unsigned int> failedCount(0);
+
+    pool.run(jobs.size(), [&](size_t index) {
+        json result = runJob(jobs[index]);
+        result["index"] = index;
+
+        if (result["status"] != "ok") {
+            failedCount++;
+        }
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        output << result.dump() << std::endl;
+    });
+
+    return failedCount;
+}
+
+json BatchRunner::runJob(const BatchJob &job) {
+    json result;
+    result["rom"] = job.romFileName;
+
+    MasterSystem *system = nullptr;
+    ReplayInputSource *replay = nullptr;
+    unsigned long framesEmulated = 0;
+
+    SoundConfig soundConfig;
+    SnapshotInputInterface input;
+    PSGHashOutputSink audioOutput;
+
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        if (!job.inputFileName.empty()) {
+            replay = new ReplayInputSource(job.inputFileName);
+        }
+
+        unsigned long frameCount = job.frames;
+
+        if (frameCount == 0) {
+            frameCount = replay ? replay->getFrameCount() : BATCH_DEFAULT_FRAME_COUNT;
+        }
+
+        // Checked here as well, so that the result says why the ROM couldn't be loaded
+        if (!Utils::fileExists(job.romFileName)) {
+            throw GeneralException(Utils::implodeString({"ROM file '", job.romFileName, "' does not exist"}));
+        }
+
+        system = new MasterSystem(&input, &soundConfig, &audioOutput);
+
+        if (!system->init(job.romFileName)) {
+            throw GeneralException(Utils::implodeString({"Unable to load ROM '", job.romFileName, "'"}));
+        }
+
+        while (framesEmulated < frameCount && system->isRunning()) {
+            InputFrame inputFrame;
+
+            if (replay && replay->nextFrame(inputFrame)) {
+                input.setSnapshot(inputFrame.controls);
+
+                if (inputFrame.pausePressed) {
+                    system->sendPauseInterrupt();
+                }
+            } else {
+                input.setSnapshot(InputSnapshot());
+            }
+
+            system->emulateFrame(true);
+            framesEmulated++;
+        }
+
+        result["status"] = framesEmulated == frameCount ? "ok" : "stopped";
+        result["frameHash"] = formatHash(Utils::fnv1aHash(system->getVideoOutput(), CONSOLE_VIDEO_OUTPUT_SIZE));
+    } catch (GeneralException &e) {
+        result["status"] = "error";
+        result["error"] = e.what();
+    } catch (std::exception &e) {
+        result["status"] = "error";
+        result["error"] = e.what();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Audio up to the point of an exception is still hashed, as it can help to tell failures apart
+    delete(system);
+    delete(replay);
+
+    result["frames"] = framesEmulated;
+    result["audioHash"] = formatHash(audioOutput.getHash());
+    result["seconds"] = elapsed.count();
+    result["fps"] = elapsed.count() > 0 ? framesEmulated / elapsed.count() : 0;
+
+    return result;
+}
+
+std::string BatchRunner::formatHash(uint64_t hash) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+    return ss.str();
+}
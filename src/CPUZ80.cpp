@@ -100,6 +100,11 @@ int CPUZ80::executeOpcode() {
         return 4; // TODO not sure what to return here in terms of cycles taken, look into it - assume 4 for now
     }
 
+    // Only instructions in pages with a breakpoint are checked, and pages are only looked up if there are any breakpoints
+    if (memory->hasBreakpoints() && memory->isBreakpointPage(programCounter)) {
+        memory->checkBreakpoint(programCounter);
+    }
+
     unsigned char opcode = NBHideFromTrace();
 
     // The first 7 bits of R should be incremented upon fetching each instruction.
@@ -305,6 +310,51 @@ void CPUZ80::raisePauseInterrupt() {
     pauseInterruptWaiting = true;
 }
 
+void CPUZ80::saveState(StateWriter &writer) {
+    writer.beginSection(SaveStateSection::SaveStateCPU);
+
+    for (auto &gpRegister : gpRegisters) {
+        writer.writeWord(gpRegister.whole);
+    }
+
+    writer.writeWord(programCounter);
+    writer.writeWord(stackPointer);
+    writer.writeByte(registerI);
+    writer.writeByte(registerR);
+    writer.writeBool(iff1);
+    writer.writeBool(iff2);
+    writer.writeBool(enableInterrupts);
+    writer.writeByte(interruptMode);
+    writer.writeBool(pauseInterruptWaiting);
+    writer.writeByte(state);
+}
+
+void CPUZ80::loadState(StateReader &reader) {
+    reader.beginSection(SaveStateSection::SaveStateCPU);
+
+    for (auto &gpRegister : gpRegisters) {
+        gpRegister.whole = reader.readWord();
+    }
+
+    originalProgramCounterValue = programCounter = reader.readWord();
+    stackPointer = reader.readWord();
+    registerI = reader.readByte();
+    registerR = reader.readByte();
+    iff1 = reader.readBool();
+    iff2 = reader.readBool();
+    enableInterrupts = reader.readBool();
+    interruptMode = reader.readByte();
+    pauseInterruptWaiting = reader.readBool();
+
+    unsigned char loadedState = reader.readByte();
+
+    if (loadedState > CPUState::Step) {
+        throw SaveStateException("Invalid CPU state " + std::to_string(loadedState));
+    }
+
+    state = (CPUState)loadedState;
+}
+
 void CPUZ80::initialiseOpcodeHandlerPointers() {
     standardOpcodeHandlers[0x00] = &CPUZ80::standardOpcodeHandler0x00;
     standardOpcodeHandlers[0x01] = &CPUZ80::standardOpcodeHandler0x01;
@@ -0,0 +1,158 @@
+#include <fstream>
+#include <cstring>
+#include "CartridgeRAM.h"
+#include "Utils.h"
+#include "Log.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+CartridgeRAM::CartridgeRAM() {
+    buffer.resize(CARTRIDGE_RAM_SIZE, 0x0);
+    data = buffer.data();
+    mappedFile = nullptr;
+    isUsed = false;
+    isSpeculative = false;
+}
+
+CartridgeRAM::~CartridgeRAM() {
+    if (mappedFile != nullptr) {
+        unmapFile();
+    } else if (isUsed && !saveFileName.empty()) {
+        writeFile();
+    }
+}
+
+void CartridgeRAM::setSaveFile(const std::string &fileName) {
+    if (mappedFile != nullptr) {
+        unmapFile();
+    }
+
+    saveFileName = fileName;
+
+    if (!Utils::fileExists(saveFileName)) {
+        // Created once the game uses the RAM (straight away if it already has)
+        if (isUsed) {
+            isUsed = false;
+            use();
+        }
+
+        return;
+    }
+
+    isUsed = true;
+
+    if (!mapFile(false)) {
+        readFile();
+    }
+}
+
+void CartridgeRAM::use() {
+    // Left until the RAM is used for real, in case the speculative frames are undone
+    if (isUsed || isSpeculative) {
+        return;
+    }
+
+    isUsed = true;
+
+    if (!saveFileName.empty()) {
+        mapFile(true);
+    }
+}
+
+void CartridgeRAM::setSpeculative(bool speculative) {
+    if (speculative == isSpeculative) {
+        return;
+    }
+
+    isSpeculative = speculative;
+
+    if (speculative) {
+        speculativeBuffer.resize(CARTRIDGE_RAM_SIZE);
+        std::memcpy(speculativeBuffer.data(), data, CARTRIDGE_RAM_SIZE);
+        data = speculativeBuffer.data();
+    } else {
+        data = mappedFile != nullptr ? (unsigned char *)mappedFile : buffer.data();
+    }
+}
+
+unsigned char *CartridgeRAM::getBank(unsigned int bank) {
+    return data + (bank * CARTRIDGE_RAM_BANK_SIZE);
+}
+
+unsigned char *CartridgeRAM::getData() {
+    return data;
+}
+
+bool CartridgeRAM::mapFile(bool copyBuffer) {
+#ifdef _WIN32
+    return false;
+#else
+    int fileDescriptor = open(saveFileName.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (fileDescriptor < 0) {
+        Log::error("Unable to open save file " + saveFileName);
+        return false;
+    }
+
+    struct stat fileStat{};
+
+    // A smaller file (e.g. only 8KB, which is all most games use) is extended with zeroes
+    if (fstat(fileDescriptor, &fileStat) != 0 || (fileStat.st_size < CARTRIDGE_RAM_SIZE && ftruncate(fileDescriptor, CARTRIDGE_RAM_SIZE) != 0)) {
+        Log::error("Unable to resize save file " + saveFileName);
+        close(fileDescriptor);
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, CARTRIDGE_RAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+    // A mapping stays valid once the file is closed
+    close(fileDescriptor);
+
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    mappedFile = mapping;
+    data = (unsigned char *)mapping;
+
+    if (copyBuffer) {
+        std::memcpy(data, buffer.data(), CARTRIDGE_RAM_SIZE);
+    }
+
+    return true;
+#endif
+}
+
+void CartridgeRAM::unmapFile() {
+#ifndef _WIN32
+    // Keep the contents, in case the RAM carries on being used without a file
+    std::memcpy(buffer.data(), mappedFile, CARTRIDGE_RAM_SIZE);
+    munmap(mappedFile, CARTRIDGE_RAM_SIZE);
+#endif
+
+    mappedFile = nullptr;
+
+    if (!isSpeculative) {
+        data = buffer.data();
+    }
+}
+
+void CartridgeRAM::readFile() {
+    std::ifstream file(saveFileName, std::ios::binary);
+    file.read((char *)buffer.data(), CARTRIDGE_RAM_SIZE);
+}
+
+void CartridgeRAM::writeFile() {
+    std::ofstream file(saveFileName, std::ios::binary);
+    file.write((const char *)buffer.data(), CARTRIDGE_RAM_SIZE);
+
+    if (!file) {
+        Log::error("Unable to write save file " + saveFileName);
+    }
+}
@@ -5,6 +5,7 @@
 #include <iostream>
 #include "Config.h"
 #include "Exceptions.h"
+#include "RunAhead.h"
 
 Config::Config() {
     // Set some default values
@@ -12,7 +13,12 @@ Config::Config() {
     displayHeight = 480;
     fullScreenMode = false;
     preserveAspectRatio = false;
+    syncToDisplay = false;
     pauseEmulationWhenNotInFocus = true;
+    fastForwardSpeed = 0;
+    rewindSeconds = 30;
+    rewindMemoryLimit = 32;
+    runAheadFrames = 0;
 
     player1Controls = new PlayerControlConfig();
     player1Controls->setDefaults();
@@ -60,6 +66,10 @@ bool Config::getPreserveAspectRatio() {
     return preserveAspectRatio;
 }
 
+bool Config::getSyncToDisplay() {
+    return syncToDisplay;
+}
+
 bool Config::isFullScreenMode() {
     return fullScreenMode;
 }
@@ -68,6 +78,22 @@ bool Config::getPauseEmulationWhenNotInFocus() {
     return pauseEmulationWhenNotInFocus;
 }
 
+int Config::getFastForwardSpeed() {
+    return fastForwardSpeed;
+}
+
+int Config::getRewindSeconds() {
+    return rewindSeconds;
+}
+
+int Config::getRewindMemoryLimit() {
+    return rewindMemoryLimit;
+}
+
+int Config::getRunAheadFrames() {
+    return runAheadFrames;
+}
+
 PlayerControlConfig *Config::getPlayer1ControlConfig() {
     return player1Controls;
 }
@@ -138,6 +164,10 @@ void Config::readDisplayConfigurationJson(json displayConfigurationJson) {
         preserveAspectRatio = JsonHandler::getBoolean(displayConfigurationJson, "preserveAspectRatio");
     }
 
+    if (JsonHandler::keyExists(displayConfigurationJson, "syncToDisplay")) {
+        syncToDisplay = JsonHandler::getBoolean(displayConfigurationJson, "syncToDisplay");
+    }
+
 }
 
 void Config::readGeneralConfigurationJson(nlohmann::json generalConfigurationJson) {
@@ -146,6 +176,38 @@ void Config::readGeneralConfigurationJson(nlohmann::json generalConfigurationJso
         pauseEmulationWhenNotInFocus = JsonHandler::getBoolean(generalConfigurationJson, "pauseEmulationWhenNotInFocus");
     }
 
+    if (JsonHandler::keyExists(generalConfigurationJson, "fastForwardSpeed")) {
+        fastForwardSpeed = JsonHandler::getInteger(generalConfigurationJson, "fastForwardSpeed");
+
+        if (fastForwardSpeed < 0) {
+            throw ConfigurationException("Fast forward speed must be 0 (unlimited) or a speed multiplier");
+        }
+    }
+
+    if (JsonHandler::keyExists(generalConfigurationJson, "rewindSeconds")) {
+        rewindSeconds = JsonHandler::getInteger(generalConfigurationJson, "rewindSeconds");
+
+        if (rewindSeconds < 0) {
+            throw ConfigurationException("Rewind seconds must be 0 (disabled) or more");
+        }
+    }
+
+    if (JsonHandler::keyExists(generalConfigurationJson, "rewindMemoryLimit")) {
+        rewindMemoryLimit = JsonHandler::getInteger(generalConfigurationJson, "rewindMemoryLimit");
+
+        if (rewindMemoryLimit < 1) {
+            throw ConfigurationException("Rewind memory limit must be at least 1 (megabyte)");
+        }
+    }
+
+    if (JsonHandler::keyExists(generalConfigurationJson, "runAheadFrames")) {
+        runAheadFrames = JsonHandler::getInteger(generalConfigurationJson, "runAheadFrames");
+
+        if (runAheadFrames < 0 || runAheadFrames > RUN_AHEAD_MAX_FRAMES) {
+            throw ConfigurationException("Run-ahead frames must be between 0 (disabled) and " + std::to_string(RUN_AHEAD_MAX_FRAMES));
+        }
+    }
+
 }
 
 void Config::writeConfigFile(const std::string& fileName) {
@@ -202,6 +264,7 @@ json Config::getDisplayConfigurationJson() {
     output["displayHeight"] = displayHeight;
     output["fullScreenMode"] = fullScreenMode;
     output["preserveAspectRatio"] = preserveAspectRatio;
+    output["syncToDisplay"] = syncToDisplay;
 
     return output;
 }
@@ -210,6 +273,10 @@ json Config::getGeneralConfigurationJson() {
     json output;
 
     output["pauseEmulationWhenNotInFocus"] = pauseEmulationWhenNotInFocus;
+    output["fastForwardSpeed"] = fastForwardSpeed;
+    output["rewindSeconds"] = rewindSeconds;
+    output["rewindMemoryLimit"] = rewindMemoryLimit;
+    output["runAheadFrames"] = runAheadFrames;
 
     return output;
 }
@@ -1,25 +1,89 @@
 #include "Emulator.h"
 #include "ProjectInfo.h"
+#include "PSGAudioStream.h"
+#include "PSGWaveFileWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
-Emulator::Emulator() {
+Emulator::Emulator() : inputMessages(EMULATOR_INPUT_QUEUE_SIZE), frameExchange(CONSOLE_VIDEO_OUTPUT_SIZE) {
     system = nullptr;
     window = nullptr;
+    audioOutput = nullptr;
+    rewindBuffer = nullptr;
+    runAhead = nullptr;
     config = new Config();
-    inputInterface = new InputInterface(config);
+    keyboardInput = new KeyboardInputInterface(config);
+    emulatedInput = new SnapshotInputInterface();
+    liveInput = new LiveInputSource();
+    inputSource = liveInput;
+    isEmulationThreadRunning = false;
+    hasEmulationThreadFailed = false;
+    presentCount = 0;
+    isDisplaySynced = false;
+    consoleFrameRate = 60;
+    averagePresentInterval = 0;
+    measuredPresentCount = 0;
 
     renderWidth = 256;
     renderHeight = 224;
+    textureRequiresFullUpload = true;
+    redrawRequired = true;
 }
 
 Emulator::~Emulator() {
+    stopEmulationThread();
+
     if (system) {
         delete(system);
     }
+
+    // Deleted after the system, as the PSG writes to it until then
+    if (audioOutput) {
+        delete(audioOutput);
+    }
+
+    if (rewindBuffer) {
+        delete(rewindBuffer);
+    }
+
+    if (runAhead) {
+        delete(runAhead);
+    }
+
+    // Closes any recording
+    if (inputSource != liveInput) {
+        delete(inputSource);
+    }
+
+    delete(liveInput);
+    delete(keyboardInput);
+    delete(emulatedInput);
+}
+
+PSGOutputSink *Emulator::createAudioOutput() {
+    SoundConfig *soundConfig = config->getSoundConfig();
+
+    switch (soundConfig->getOutputType()) {
+        case SoundOutputType::WaveFile:
+            return new PSGWaveFileWriter(soundConfig->getOutputFileName(), soundConfig->getSampleRate(), false);
+        case SoundOutputType::RawFile:
+            return new PSGWaveFileWriter(soundConfig->getOutputFileName(), soundConfig->getSampleRate(), true);
+        case SoundOutputType::NoOutput:
+            return new PSGNullOutputSink();
+        case SoundOutputType::Playback:
+        default: {
+            auto stream = new PSGAudioStream(soundConfig->getSampleRate());
+            stream->setVolume((float)soundConfig->getVolume());
+            return stream;
+        }
+    }
 }
 
 void Emulator::init(const std::string &fileName) {
     // TODO detect ROM type and support multiple consoles if we ever get master system support fully working
-    system = new MasterSystem(inputInterface, config);
+    audioOutput = createAudioOutput();
+    system = new MasterSystem(emulatedInput, config->getSoundConfig(), audioOutput);
 
     bool romLoadResult = system->init(fileName);
 
@@ -28,7 +92,46 @@ void Emulator::init(const std::string &fileName) {
         throw GeneralException("Failed to load ROM file");
     }
 
+    // Saves are kept next to the ROM, e.g. roms/game.sms saves to roms/game.sav
+    std::string saveFileName = fileName;
+    size_t extension = saveFileName.find_last_of('.');
+
+    if (extension != std::string::npos && saveFileName.find_first_of("/\\", extension) == std::string::npos) {
+        saveFileName.erase(extension);
+    }
+
+    this->saveFileName = saveFileName + ".sav";
 
+    if (config->getRewindSeconds() > 0) {
+        auto maxStates = (size_t)std::ceil(config->getRewindSeconds() * system->getCurrentFrameRate());
+        rewindBuffer = new RewindBuffer(system->getSaveStateSize(), (size_t)config->getRewindMemoryLimit() * 1024 * 1024, maxStates);
+    }
+
+    if (config->getRunAheadFrames() > 0) {
+        runAhead = new RunAhead(system, (unsigned int)config->getRunAheadFrames());
+    }
+}
+
+void Emulator::recordInput(const std::string &fileName) {
+    if (inputSource != liveInput) {
+        delete(inputSource);
+    }
+
+    inputSource = new RecordingInputSource(liveInput, fileName);
+
+    // Recordings always start from blank cartridge RAM, so that they play back the same whatever the save file holds
+    saveFileName.clear();
+}
+
+void Emulator::replayInput(const std::string &fileName) {
+    if (inputSource != liveInput) {
+        delete(inputSource);
+    }
+
+    inputSource = new ReplayInputSource(fileName);
+
+    // The replay mustn't start from (or write to) the user's save, see recordInput()
+    saveFileName.clear();
 }
 
 void Emulator::run() {
@@ -38,34 +141,63 @@ void Emulator::run() {
 
     sf::Keyboard::Key pauseKey = sf::Keyboard::Unknown;
     sf::Keyboard::Key exitKey = sf::Keyboard::Unknown;
+    sf::Keyboard::Key fastForwardKey = sf::Keyboard::Unknown;
+    sf::Keyboard::Key rewindKey = sf::Keyboard::Unknown;
 
     if (config->getGeneralControlConfig() && config->getGeneralControlConfig()->getKeyboardConfig()) {
         exitKey = config->getGeneralControlConfig()->getKeyboardConfig()->getExitKey();
         pauseKey = config->getGeneralControlConfig()->getKeyboardConfig()->getPauseKey();
+        fastForwardKey = config->getGeneralControlConfig()->getKeyboardConfig()->getFastForwardKey();
+        rewindKey = config->getGeneralControlConfig()->getKeyboardConfig()->getRewindKey();
     }
 
-    bool pauseEmulationWhenNotInFocus = config->getPauseEmulationWhenNotInFocus();
-
 //    bool hasPrintedVdpInfo = false;
 
     bool hasFocus = true;
 
+    EmulatorInputMessage lastInputMessage = {InputSnapshot(), true, false, false, false};
+
+    // Only attached now that it's known whether input is being recorded or replayed
+    if (!saveFileName.empty()) {
+        system->setCartridgeRAMFile(saveFileName);
+    }
+
+    consoleFrameRate = system->getCurrentFrameRate();
+    isEmulationThreadRunning = true;
+    emulationThread = std::thread(&Emulator::runEmulationThread, this);
+
     while (window->isOpen()) {
 
+        if (hasEmulationThreadFailed) {
+            stopEmulationThread();
+            std::rethrow_exception(emulationThreadException);
+        }
+
+        bool pausePressed = false;
+
         sf::Event event;
         while (window->pollEvent(event)) {
 
             if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && exitKey != sf::Keyboard::Unknown && event.key.code == exitKey)) {
+                stopEmulationThread();
+#ifdef VERBOSE_MODE
+                system->printAudioInformation();
+#endif
                 window->close();
                 return;
             }
 
             if (event.type == sf::Event::KeyPressed && pauseKey != sf::Keyboard::Unknown && event.key.code == pauseKey) {
-                system->sendPauseInterrupt();
+                pausePressed = true;
             }
 
             if (event.type == sf::Event::GainedFocus) {
                 hasFocus = true;
+                redrawRequired = true;
+            }
+
+            if (event.type == sf::Event::Resized) {
+                redrawRequired = true;
             }
 
             if (event.type == sf::Event::LostFocus) {
@@ -73,14 +205,46 @@ void Emulator::run() {
             }
         }
 
-        if (hasFocus || !pauseEmulationWhenNotInFocus) {
-            system->emulateFrame(hasFocus);
-            videoOutputTexture.update(system->getVideoOutput());
+        // Controls are only read while the window has focus, so that typing into other windows doesn't move anything
+        EmulatorInputMessage inputMessage = {
+                hasFocus ? InputSnapshot::capture(keyboardInput) : lastInputMessage.controls,
+                hasFocus,
+                pausePressed,
+                hasFocus && fastForwardKey != sf::Keyboard::Unknown && sf::Keyboard::isKeyPressed(fastForwardKey),
+                hasFocus && rewindKey != sf::Keyboard::Unknown && sf::Keyboard::isKeyPressed(rewindKey)
+        };
+
+        if (pausePressed || inputMessage.hasFocus != lastInputMessage.hasFocus || inputMessage.controls != lastInputMessage.controls
+            || inputMessage.fastForward != lastInputMessage.fastForward || inputMessage.rewind != lastInputMessage.rewind) {
+            // If the queue is full the emulation thread has stalled, so there is nothing better to do than drop this
+            inputMessages.push(inputMessage);
+            lastInputMessage = inputMessage;
         }
 
-        window->clear(sf::Color::Black);
-        window->draw(videoOutputSprite);
-        window->display();
+        // Only the newest frame is shown, any which were finished since the last refresh are skipped
+        const VideoFrame *frame = frameExchange.acquireLatest();
+
+        if (frame) {
+
+            if (frame->width != renderWidth || frame->height != renderHeight) {
+                renderWidth = frame->width;
+                renderHeight = frame->height;
+                setRenderingTexture();
+            }
+
+            redrawRequired = updateVideoOutputTexture(frame) || redrawRequired;
+
+            // When synced to the display, the emulation thread waits for every frame to be presented
+            redrawRequired = redrawRequired || isDisplaySynced;
+        }
+
+        if (redrawRequired) {
+            present();
+            redrawRequired = false;
+        } else {
+            // Nothing new to show - check again shortly rather than spinning
+            sf::sleep(sf::milliseconds(1));
+        }
 
         // Lazy way to debug the VDP...
 //        if (!hasPrintedVdpInfo && sf::Keyboard::isKeyPressed(sf::Keyboard::V)) {
@@ -91,18 +255,281 @@ void Emulator::run() {
 //        if (hasPrintedVdpInfo && !sf::Keyboard::isKeyPressed(sf::Keyboard::V)) {
 //            hasPrintedVdpInfo = false;
 //        }
+    }
+
+    stopEmulationThread();
+    delete(window);
+    window = nullptr;
+}
 
-        unsigned short consoleDisplayWidth = system->getCurrentDisplayWidth();
-        unsigned short consoleDisplayHeight = system->getCurrentDisplayHeight();
+void Emulator::present() {
+    window->clear(sf::Color::Black);
+    window->draw(videoOutputSprite);
+    window->display();
 
-        if (consoleDisplayWidth != renderWidth || consoleDisplayHeight != renderHeight) {
-            renderWidth = consoleDisplayWidth;
-            renderHeight = consoleDisplayHeight;
-            setRenderingTexture();
+    auto now = std::chrono::steady_clock::now();
+    double interval = std::chrono::duration<double>(now - lastPresentTime).count();
+    lastPresentTime = now;
+    ++presentCount;
+
+    if (!config->getSyncToDisplay()) {
+        return;
+    }
+
+    // Gaps of more than one and a half frames are from frames which weren't ready in time (or nothing changing), not the refresh rate
+    if (interval > 1.5 / consoleFrameRate) {
+        return;
+    }
+
+    if (measuredPresentCount < DISPLAY_SYNC_MEASUREMENT_FRAMES) {
+        averagePresentInterval += (interval - averagePresentInterval) / ++measuredPresentCount;
+    } else {
+        averagePresentInterval += (interval - averagePresentInterval) / DISPLAY_SYNC_MEASUREMENT_FRAMES;
+    }
+
+    if (measuredPresentCount >= DISPLAY_SYNC_MEASUREMENT_FRAMES) {
+        double refreshRate = 1.0 / averagePresentInterval;
+        isDisplaySynced = std::abs((refreshRate / consoleFrameRate) - 1.0) <= DISPLAY_SYNC_TOLERANCE;
+    }
+}
+
+void Emulator::waitForPresent(unsigned long previousPresentCount, std::chrono::steady_clock::time_point frameStartTime) {
+    auto frameTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / consoleFrameRate));
+
+    // If the display stops presenting (e.g. the window is minimised), carry on after a couple of frames rather than stopping
+    auto timeout = std::chrono::steady_clock::now() + (frameTime * 2);
+
+    while (presentCount == previousPresentCount && std::chrono::steady_clock::now() < timeout && isEmulationThreadRunning) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // In case presents aren't actually waiting for vsync, never go more than slightly faster than the console's own rate
+    std::this_thread::sleep_until(frameStartTime + (frameTime * 95 / 100));
+}
+
+void Emulator::runEmulationThread() {
+    FramePacer pacer(consoleFrameRate);
+    const auto frameDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / consoleFrameRate));
+
+    bool pauseEmulationWhenNotInFocus = config->getPauseEmulationWhenNotInFocus();
+    int fastForwardSpeed = config->getFastForwardSpeed();
+    bool hasFocus = true;
+    bool isFastForwarding = false;
+    bool isRewinding = false;
+
+    auto lastPublishTime = std::chrono::steady_clock::now();
+
+    try {
+        while (isEmulationThreadRunning) {
+            EmulatorInputMessage inputMessage;
+            bool fastForward = isFastForwarding;
+            bool rewind = isRewinding;
+
+            while (inputMessages.pop(inputMessage)) {
+                liveInput->setControls(inputMessage.controls);
+                hasFocus = inputMessage.hasFocus;
+                fastForward = inputMessage.fastForward;
+
+                // Going back would make a recording or replay no longer match what was actually played
+                rewind = inputMessage.rewind && rewindBuffer && inputSource == liveInput;
+
+                if (inputMessage.pausePressed) {
+                    liveInput->pressPause();
+                }
+            }
+
+            if (fastForward != isFastForwarding) {
+                isFastForwarding = fastForward;
+
+                // The audio can't keep up with the emulation, so it's muted rather than being left to overflow
+                system->setAudioMuted(isFastForwarding || isRewinding);
+                system->setVideoRenderingEnabled(true);
+                pacer.setFrameRate(isFastForwarding && fastForwardSpeed > 0 ? consoleFrameRate * fastForwardSpeed : consoleFrameRate);
+            }
+
+            if (rewind != isRewinding) {
+                isRewinding = rewind;
+
+                // Frames which are emulated again while rewinding would only sound like noise
+                system->setAudioMuted(isFastForwarding || isRewinding);
+                system->setVideoRenderingEnabled(true);
+            }
+
+            bool isRunningFrame = hasFocus || !pauseEmulationWhenNotInFocus;
+            bool hasPublished = false;
+            unsigned long previousPresentCount = presentCount;
+            auto frameStartTime = std::chrono::steady_clock::now();
+
+            if (isRunningFrame && isRewinding) {
+                if (rewindFrame()) {
+                    publishVideoFrame();
+                    lastPublishTime = std::chrono::steady_clock::now();
+                    hasPublished = true;
+                }
+            } else if (isRunningFrame) {
+                InputFrame inputFrame;
+
+                if (!inputSource->nextFrame(inputFrame)) {
+                    // The replay has finished, so the user takes over from here
+                    delete(inputSource);
+                    inputSource = liveInput;
+                    liveInput->nextFrame(inputFrame);
+                }
+
+                emulatedInput->setSnapshot(inputFrame.controls);
+
+                if (inputFrame.pausePressed) {
+                    system->sendPauseInterrupt();
+                }
+
+                // The frame's input is always latched, as it already stays the same while the window isn't focused,
+                // and a replay must be read on every frame even if the window isn't focused
+                if (runAhead && !isFastForwarding) {
+                    runAhead->emulateFrame(true);
+                } else {
+                    system->emulateFrame(true);
+                }
+
+                recordRewindState();
+
+                auto frameEndTime = std::chrono::steady_clock::now();
+
+                if (!isFastForwarding || frameEndTime - lastPublishTime >= frameDuration) {
+                    publishVideoFrame();
+                    lastPublishTime = frameEndTime;
+                    hasPublished = true;
+                }
+
+                if (isFastForwarding) {
+                    // Only draw frames which are likely to be shown. Rendering only changes at the start of a VDP frame,
+                    // so it is turned on a couple of frames before the next frame is due to be shown.
+                    auto frameTime = std::max<std::chrono::steady_clock::duration>(frameEndTime - frameStartTime, fastForwardSpeed > 0 ? frameDuration / fastForwardSpeed : std::chrono::steady_clock::duration::zero());
+                    system->setVideoRenderingEnabled(frameEndTime + (frameTime * 2) >= lastPublishTime + frameDuration);
+                }
+            }
+
+            if (isFastForwarding && fastForwardSpeed == 0) {
+                // Unlimited speed
+                continue;
+            }
+
+            if (!isFastForwarding && hasPublished && isDisplaySynced) {
+                // Start the next frame once this one has been shown
+                waitForPresent(previousPresentCount, frameStartTime);
+
+                // So that the pacer carries on from here if the display stops being in sync
+                pacer.reset();
+            } else {
+                pacer.waitForNextFrame();
+            }
         }
+
+#ifdef VERBOSE_MODE
+        pacer.printDebugInfo();
+
+        if (rewindBuffer) {
+            rewindBuffer->printDebugInfo();
+        }
+
+        if (runAhead) {
+            runAhead->printDebugInfo();
+        }
+#endif
+    } catch (...) {
+        emulationThreadException = std::current_exception();
+        hasEmulationThreadFailed = true;
     }
-    delete(window);
-    window = nullptr;
+}
+
+void Emulator::recordRewindState() {
+    if (!rewindBuffer) {
+        return;
+    }
+
+    system->saveState(rewindBuffer->getWriteBuffer(), system->getSaveStateSize());
+    rewindBuffer->push();
+}
+
+bool Emulator::rewindFrame() {
+    const uint8_t *state = rewindBuffer->stepBack();
+
+    if (!state) {
+        return false;
+    }
+
+    const uint8_t *previousState = rewindBuffer->stepBack();
+
+    if (!previousState) {
+        // Reached the oldest state, which stays where it is until more history has been recorded
+        system->restoreState(state, system->getSaveStateSize());
+        return false;
+    }
+
+    system->restoreState(previousState, system->getSaveStateSize());
+
+    // The input latched in the state is used rather than whatever is being held down now
+    system->emulateFrame(false);
+    recordRewindState();
+
+    return true;
+}
+
+void Emulator::stopEmulationThread() {
+    isEmulationThreadRunning = false;
+
+    if (emulationThread.joinable()) {
+        emulationThread.join();
+    }
+}
+
+void Emulator::publishVideoFrame() {
+    VideoFrame *frame = frameExchange.getWriteFrame();
+
+    // The write frame may be a couple of frames old, so always copy the whole output
+    std::copy(system->getVideoOutput(), system->getVideoOutput() + CONSOLE_VIDEO_OUTPUT_SIZE, frame->pixels.begin());
+
+    frame->width = system->getCurrentDisplayWidth();
+    frame->height = system->getCurrentDisplayHeight();
+
+    unsigned short firstLine = 0;
+    unsigned short lastLine = 0;
+
+    if (system->consumeDirtyVideoLines(firstLine, lastLine)) {
+        frame->markDirty(firstLine, lastLine);
+    }
+
+    frameExchange.publish();
+}
+
+/**
+ * Uploads the lines of a frame which have changed since the last frame that was shown to the output texture
+ * @return true if the texture has been changed
+ */
+bool Emulator::updateVideoOutputTexture(const VideoFrame *frame) {
+    unsigned short firstLine = frame->firstDirtyLine;
+    unsigned short lastLine = frame->lastDirtyLine;
+
+    bool hasChanged = frame->hasDirtyLines;
+
+    if (textureRequiresFullUpload) {
+        // The texture has been (re)created, so its contents are undefined
+        firstLine = 0;
+        lastLine = renderHeight - 1;
+        hasChanged = true;
+        textureRequiresFullUpload = false;
+    }
+
+    if (!hasChanged || firstLine >= renderHeight) {
+        return false;
+    }
+
+    lastLine = std::min(lastLine, (unsigned short)(renderHeight - 1));
+
+    const sf::Uint8 *firstLinePixels = frame->pixels.data() + (firstLine * CONSOLE_VIDEO_OUTPUT_WIDTH * 4);
+
+    videoOutputTexture.update(firstLinePixels, renderWidth, (lastLine - firstLine) + 1, 0, firstLine);
+
+    return true;
 }
 
 void Emulator::setVideoMode(unsigned int width, unsigned int height) {
@@ -112,7 +539,7 @@ void Emulator::setVideoMode(unsigned int width, unsigned int height) {
     }
 
     window = new sf::RenderWindow(sf::VideoMode(width, height, 32), Utils::getVersionString(false), config->isFullScreenMode() ? sf::Style::Fullscreen : sf::Style::Default);
-    window->setFramerateLimit(60);
+    // Emulation is paced on its own thread, so presenting only needs to wait for the display
     window->setVerticalSyncEnabled(true);
 }
 
@@ -125,7 +552,9 @@ void Emulator::setRenderingTexture() {
     float heightScale;
 
     videoOutputTexture.create((int)renderWidth, (int)renderHeight);
-    videoOutputSprite.setTexture(videoOutputTexture);
+    videoOutputSprite.setTexture(videoOutputTexture, true);
+    textureRequiresFullUpload = true;
+    redrawRequired = true;
 
     float xPosition = 0.f;
     float yPosition = 0.f;
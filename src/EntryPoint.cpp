@@ -8,6 +8,7 @@ Licensed under the GPLv3 license.
 #include "Utils.h"
 #include "Emulator.h"
 #include "Exceptions.h"
+#include "BandLimitedBuffer.h"
 
 int main(int argc, char *argv[]) {
     if (argc > 1 && std::string(argv[1]) == "-v") {
@@ -15,6 +16,18 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
+    if (argc > 1 && std::string(argv[1]) == "-benchmark-audio") {
+        // PSG output changes are timed in emulated CPU cycles, which run at twice the Z80's 3.58Mhz
+        const double clockRate = 3579545.0 * 2;
+
+        for (unsigned int sampleRate : {44100, 48000, 96000}) {
+            double load = BandLimitedBuffer::benchmark(sampleRate, clockRate);
+            std::cout << sampleRate << "Hz: " << (load * 100) << "% of one core" << std::endl;
+        }
+
+        return 0;
+    }
+
     // Start the Emulator
     try {
         Emulator *emulator = new Emulator();
@@ -31,7 +44,25 @@ int main(int argc, char *argv[]) {
         }
 
         emulator->init(romFileName);
+
+        // Input can be recorded to, or replayed from, a movie file with -record <file> or -replay <file>
+        for (int i = 2; i < argc - 1; i += 2) {
+            std::string option = argv[i];
+
+            if (option == "-record") {
+                emulator->recordInput(argv[i + 1]);
+            } else if (option == "-replay") {
+                emulator->replayInput(argv[i + 1]);
+            } else {
+                std::cout<<"Unknown option '"<<option<<"'"<<std::endl;
+                return 1;
+            }
+        }
+
         emulator->run();
+
+        // Shuts down the machine, which finishes off any audio output file
+        delete(emulator);
     } catch (GeneralException &e) {
         std::cout<<e.what()<<std::endl;
     } catch (std::exception &e) {
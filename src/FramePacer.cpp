@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include "FramePacer.h"
+
+FramePacer::FramePacer(double frameRate) {
+    spinTime = std::chrono::nanoseconds(FRAME_PACER_MIN_SPIN_TIME_NS);
+    waitCount = 0;
+    totalJitterNanoseconds = 0;
+    maxJitterNanoseconds = 0;
+    resyncCount = 0;
+
+    setFrameRate(frameRate);
+}
+
+void FramePacer::setFrameRate(double frameRate) {
+    this->frameRate = frameRate;
+    framePeriodPicoseconds = (uint64_t)std::llround(1e12 / frameRate);
+    reset();
+}
+
+double FramePacer::getFrameRate() {
+    return frameRate;
+}
+
+void FramePacer::reset() {
+    startTime = Clock::now();
+    frameIndex = 0;
+}
+
+FramePacer::Clock::time_point FramePacer::getDeadline(uint64_t frame) {
+    return startTime + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds((frame * framePeriodPicoseconds) / 1000));
+}
+
+void FramePacer::waitForNextFrame() {
+    ++frameIndex;
+
+    Clock::time_point deadline = getDeadline(frameIndex);
+    Clock::time_point now = Clock::now();
+
+    if (now > getDeadline(frameIndex + FRAME_PACER_MAX_FRAMES_BEHIND)) {
+        // Too far behind (e.g. the system was busy) - running flat out to catch up would be worse than skipping ahead
+        ++resyncCount;
+        reset();
+        return;
+    }
+
+    if (deadline - now > spinTime) {
+        Clock::time_point wakeTarget = deadline - spinTime;
+        std::this_thread::sleep_until(wakeTarget);
+
+        // Adapt the spin time to how late sleeps are waking up, with some headroom
+        auto oversleep = Clock::now() - wakeTarget;
+        auto wanted = std::min<Clock::duration>(std::max<Clock::duration>(oversleep * 2, std::chrono::nanoseconds(FRAME_PACER_MIN_SPIN_TIME_NS)), std::chrono::nanoseconds(FRAME_PACER_MAX_SPIN_TIME_NS));
+        spinTime = (spinTime * 7 + wanted) / 8;
+    }
+
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+
+    double jitter = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - deadline).count();
+
+    ++waitCount;
+    totalJitterNanoseconds += jitter;
+    maxJitterNanoseconds = std::max(maxJitterNanoseconds, jitter);
+}
+
+double FramePacer::getAverageJitterMicroseconds() {
+    return waitCount > 0 ? (totalJitterNanoseconds / waitCount) / 1000 : 0;
+}
+
+double FramePacer::getMaxJitterMicroseconds() {
+    return maxJitterNanoseconds / 1000;
+}
+
+unsigned long FramePacer::getResyncCount() {
+    return resyncCount;
+}
+
+void FramePacer::printDebugInfo() {
+    std::cout << "Frame pacing: " << frameRate << "Hz, average jitter " << getAverageJitterMicroseconds() << "us, max jitter "
+              << getMaxJitterMicroseconds() << "us, resynced " << resyncCount << " times" << std::endl;
+}
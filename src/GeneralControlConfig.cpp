@@ -49,6 +49,14 @@ void GeneralControlConfigKeyboard::setFromConfig(json generalControlKeyboardConf
         exitKey = mapper->getKey(JsonHandler::getString(generalControlKeyboardConfiguration, "exit"));
     }
 
+    if (JsonHandler::keyExists(generalControlKeyboardConfiguration, "fastForward")) {
+        fastForwardKey = mapper->getKey(JsonHandler::getString(generalControlKeyboardConfiguration, "fastForward"));
+    }
+
+    if (JsonHandler::keyExists(generalControlKeyboardConfiguration, "rewind")) {
+        rewindKey = mapper->getKey(JsonHandler::getString(generalControlKeyboardConfiguration, "rewind"));
+    }
+
     delete(mapper);
 }
 
@@ -58,6 +66,8 @@ json GeneralControlConfigKeyboard::getJson() {
 
     output["exit"] = mapper->getKeyName(exitKey);
     output["pause"] = mapper->getKeyName(pauseKey);
+    output["fastForward"] = mapper->getKeyName(fastForwardKey);
+    output["rewind"] = mapper->getKeyName(rewindKey);
 
     delete (mapper);
     return output;
@@ -68,11 +78,15 @@ json GeneralControlConfigKeyboard::getJson() {
 GeneralControlConfigKeyboard::GeneralControlConfigKeyboard() {
     pauseKey = sf::Keyboard::Unknown;
     exitKey = sf::Keyboard::Unknown;
+    fastForwardKey = sf::Keyboard::Unknown;
+    rewindKey = sf::Keyboard::Unknown;
 }
 
 void GeneralControlConfigKeyboard::setDefaults() {
     pauseKey = sf::Keyboard::P;
     exitKey = sf::Keyboard::Escape;
+    fastForwardKey = sf::Keyboard::Tab;
+    rewindKey = sf::Keyboard::Backspace;
 }
 
 sf::Keyboard::Key GeneralControlConfigKeyboard::getPauseKey() {
@@ -81,4 +95,12 @@ sf::Keyboard::Key GeneralControlConfigKeyboard::getPauseKey() {
 
 sf::Keyboard::Key GeneralControlConfigKeyboard::getExitKey() {
     return exitKey;
-}
\ No newline at end of file
+}
+
+sf::Keyboard::Key GeneralControlConfigKeyboard::getFastForwardKey() {
+    return fastForwardKey;
+}
+
+sf::Keyboard::Key GeneralControlConfigKeyboard::getRewindKey() {
+    return rewindKey;
+}
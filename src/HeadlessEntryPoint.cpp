@@ -0,0 +1,372 @@
+/*
+MasterNostalgia - a Sega Master System emulator.
+Licensed under the GPLv3 license.
+ */
+
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "Utils.h"
+#include "Exceptions.h"
+#include "Log.h"
+#include "MasterSystem.h"
+#include "PSGWaveFileWriter.h"
+#include "RunAhead.h"
+#include "InputMovie.h"
+#include "BatchRunner.h"
+
+#define HEADLESS_DEFAULT_FRAME_COUNT 600
+
+// Number of times the final state is saved to measure how long it takes
+#define HEADLESS_SAVE_STATE_TIMING_RUNS 1000
+
+/**
+ * Reads an option's value as a number, throwing ConfigurationException unless the whole value is a number no larger
+ * than the maximum (rather than std::stoul's exceptions, or quietly using whatever number the value starts with)
+ */
+unsigned long parseNumberOption(const std::string &option, const std::string &value, int base, unsigned long maximum) {
+    size_t length = 0;
+    unsigned long number = 0;
+
+    // std::stoul would otherwise skip leading spaces and accept a sign
+    if (!value.empty() && std::isxdigit((unsigned char)value[0])) {
+        try {
+            number = std::stoul(value, &length, base);
+        } catch (std::logic_error &) {
+            length = 0;
+        }
+    }
+
+    if (length == 0 || length != value.size() || number > maximum) {
+        throw ConfigurationException("Invalid value '" + value + "' for " + option);
+    }
+
+    return number;
+}
+
+/**
+ * Prints every watchpoint and breakpoint hit, noting whether a breakpoint has been hit so that the run can be stopped
+ */
+class HeadlessDebugListener : public DebugListener {
+public:
+    explicit HeadlessDebugListener(Console *console) {
+        this->console = console;
+        hasHitBreakpoint = false;
+    }
+
+    void onWatchpoint(unsigned short location, unsigned char value, bool isWrite) override {
+        std::cout << "Watchpoint: " << (isWrite ? "wrote " : "read ") << Utils::formatHexNumber(value) <<
+                  (isWrite ? " to " : " from ") << Utils::formatHexNumber(location) << " at PC " <<
+                  Utils::formatHexNumber(console->getInstructionAddress()) << ", frame " << console->getCompletedFrameCount() << std::endl;
+    }
+
+    void onBreakpoint(unsigned short location) override {
+        std::cout << "Breakpoint: " << Utils::formatHexNumber(location) << ", frame " << console->getCompletedFrameCount() << std::endl;
+        hasHitBreakpoint = true;
+    }
+
+    bool hasHitBreakpoint;
+
+private:
+    Console *console;
+};
+
+/**
+ * Runs a ROM with no window, audio device or input as fast as possible, then reports how quickly it ran along with a
+ * hash of the final frame so that runs can be compared. A save state can be loaded before starting, and the final
+ * state can be saved. With run-ahead, the final frame shown is the one run ahead to, and the cost of running ahead is reported.
+ *
+ * Audio can be written to a WAV file, or with -raw to a file of just the samples (16-bit little-endian mono).
+ *
+ * Input can be replayed from a recording, in which case the whole recording is run unless a number of frames is given.
+ * Cartridge RAM is only kept in a save file if one is given, so that runs don't depend on (or change) a game's saves.
+ *
+ * Any number of watchpoints (on reads and writes, or only one of them) and breakpoints can be set on hex addresses.
+ * Every hit is printed, and the run stops at the end of the frame in which a breakpoint is hit. Frames which are run
+ * ahead don't report hits, so each hit is only printed once and only for frames which really happen.
+ *
+ * Usage: MasterNostalgiaHeadless <rom file> [-frames <count>] [-wav|-raw <audio output file>] [-load-state <file>] [-save-state <file>] [-run-ahead <frames>] [-replay <file>] [-sav <file>] [-watch|-watch-read|-watch-write|-break <address>]
+ */
+int runSingle(int argc, char *argv[]) {
+
+    std::string romFileName = argv[1];
+    unsigned long frameCount = 0;
+    std::string audioFileName;
+    bool isRawAudio = false;
+    std::string loadStateFileName;
+    std::string saveStateFileName;
+    unsigned int runAheadFrames = 0;
+    std::string replayFileName;
+    std::string saveFileName;
+    std::vector<unsigned short> watchpoints[3];
+    std::vector<unsigned short> breakpoints;
+
+    try {
+        for (int i = 2; i < argc - 1; i += 2) {
+            std::string option = argv[i];
+
+            if (option == "-frames") {
+                frameCount = parseNumberOption(option, argv[i + 1], 10, ULONG_MAX);
+            } else if (option == "-wav" || option == "-raw") {
+                audioFileName = argv[i + 1];
+                isRawAudio = option == "-raw";
+            } else if (option == "-load-state") {
+                loadStateFileName = argv[i + 1];
+            } else if (option == "-save-state") {
+                saveStateFileName = argv[i + 1];
+            } else if (option == "-run-ahead") {
+                runAheadFrames = (unsigned int)parseNumberOption(option, argv[i + 1], 10, RUN_AHEAD_MAX_FRAMES);
+            } else if (option == "-replay") {
+                replayFileName = argv[i + 1];
+            } else if (option == "-sav") {
+                saveFileName = argv[i + 1];
+            } else if (option == "-watch" || option == "-watch-read" || option == "-watch-write") {
+                // Indexed by which accesses to watch: 1 for reads, 2 for writes, 3 for both
+                unsigned int type = option == "-watch" ? 3 : (option == "-watch-read" ? 1 : 2);
+                watchpoints[type - 1].push_back((unsigned short)parseNumberOption(option, argv[i + 1], 16, 0xFFFF));
+            } else if (option == "-break") {
+                breakpoints.push_back((unsigned short)parseNumberOption(option, argv[i + 1], 16, 0xFFFF));
+            } else {
+                std::cout << "Unknown option '" << option << "'" << std::endl;
+                return 1;
+            }
+        }
+    } catch (ConfigurationException &e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        SoundConfig soundConfig;
+        SnapshotInputInterface input;
+        PSGOutputSink *audioOutput;
+        ReplayInputSource *replay = nullptr;
+
+        if (!replayFileName.empty()) {
+            replay = new ReplayInputSource(replayFileName);
+        }
+
+        if (frameCount == 0) {
+            frameCount = replay ? replay->getFrameCount() : HEADLESS_DEFAULT_FRAME_COUNT;
+        }
+
+        if (audioFileName.empty()) {
+            audioOutput = new PSGNullOutputSink();
+        } else {
+            audioOutput = new PSGWaveFileWriter(audioFileName, soundConfig.getSampleRate(), isRawAudio);
+        }
+
+        auto *system = new MasterSystem(&input, &soundConfig, audioOutput);
+
+        if (!system->init(romFileName)) {
+            delete(system);
+            delete(audioOutput);
+            delete(replay);
+            return 1;
+        }
+
+        if (!saveFileName.empty()) {
+            system->setCartridgeRAMFile(saveFileName);
+        }
+
+        HeadlessDebugListener debugListener(system);
+        system->setDebugListener(&debugListener);
+
+        for (unsigned int type = 1; type <= 3; type++) {
+            for (unsigned short location : watchpoints[type - 1]) {
+                system->addWatchpoint(location, (type & 1) != 0, (type & 2) != 0);
+            }
+        }
+
+        for (unsigned short location : breakpoints) {
+            system->addBreakpoint(location);
+        }
+
+        std::vector<uint8_t> state(system->getSaveStateSize());
+
+        if (!loadStateFileName.empty()) {
+            std::ifstream file(loadStateFileName, std::ios::binary);
+
+            if (!file) {
+                throw SaveStateException("Unable to open " + loadStateFileName);
+            }
+
+            std::vector<uint8_t> loadedState((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            system->loadState(loadedState.data(), loadedState.size());
+        }
+
+        RunAhead *runAhead = runAheadFrames > 0 ? new RunAhead(system, runAheadFrames) : nullptr;
+
+        unsigned long framesEmulated = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (framesEmulated < frameCount && system->isRunning() && !debugListener.hasHitBreakpoint) {
+            InputFrame inputFrame;
+
+            if (replay && replay->nextFrame(inputFrame)) {
+                input.setSnapshot(inputFrame.controls);
+
+                if (inputFrame.pausePressed) {
+                    system->sendPauseInterrupt();
+                }
+            } else {
+                // Nothing is pressed once the replay has finished
+                input.setSnapshot(InputSnapshot());
+            }
+
+            if (runAhead) {
+                runAhead->emulateFrame(true);
+            } else {
+                system->emulateFrame(true);
+            }
+
+            framesEmulated++;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        uint64_t frameHash = Utils::fnv1aHash(system->getVideoOutput(), CONSOLE_VIDEO_OUTPUT_SIZE);
+
+        auto saveStart = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < HEADLESS_SAVE_STATE_TIMING_RUNS; i++) {
+            system->saveState(state.data(), state.size());
+        }
+
+        std::chrono::duration<double> saveElapsed = std::chrono::steady_clock::now() - saveStart;
+
+        if (!saveStateFileName.empty()) {
+            std::ofstream file(saveStateFileName, std::ios::binary);
+            file.write((const char *)state.data(), (std::streamsize)state.size());
+
+            if (!file) {
+                throw SaveStateException("Unable to write " + saveStateFileName);
+            }
+        }
+
+        double runAheadCost = runAhead ? runAhead->getAverageCost() : 0;
+
+        if (runAhead) {
+            delete(runAhead);
+        }
+
+        if (replay) {
+            delete(replay);
+        }
+
+        delete(system);
+        delete(audioOutput);
+
+        double seconds = elapsed.count();
+
+        std::cout << "Frames: " << framesEmulated << std::endl;
+        std::cout << "Time: " << seconds << "s" << std::endl;
+        std::cout << "Emulated FPS: " << (seconds > 0 ? framesEmulated / seconds : 0) << std::endl;
+        std::cout << "Host ns per frame: " << (framesEmulated > 0 ? (seconds * 1e9) / framesEmulated : 0) << std::endl;
+        std::cout << "Frame hash: " << std::hex << std::setw(16) << std::setfill('0') << frameHash << std::dec << std::setfill(' ') << std::endl;
+        std::cout << "Save state: " << state.size() << " bytes, " << (saveElapsed.count() * 1e6) / HEADLESS_SAVE_STATE_TIMING_RUNS << "us to save" << std::endl;
+
+        if (runAheadFrames > 0) {
+            std::cout << "Run-ahead: " << runAheadFrames << " frame(s), " << runAheadCost * 1e6 << "us per frame" << std::endl;
+        }
+    } catch (GeneralException &e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    } catch (std::exception &e) {
+        std::cout << "An exception has occurred but no error message was provided." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Runs every ROM listed in a manifest across a pool of threads, see BatchRunner. Results are written as lines of JSON to
+ * the output file (or stdout), with a summary on stderr.
+ *
+ * Usage: MasterNostalgiaHeadless -batch <manifest file> [-threads <count>] [-output <file>]
+ */
+int runBatch(int argc, char *argv[]) {
+    std::string manifestFileName = argv[2];
+    unsigned int threadCount = 0;
+    std::string outputFileName;
+
+    try {
+        for (int i = 3; i < argc - 1; i += 2) {
+            std::string option = argv[i];
+
+            if (option == "-threads") {
+                threadCount = (unsigned int)parseNumberOption(option, argv[i + 1], 10, UINT_MAX);
+            } else if (option == "-output") {
+                outputFileName = argv[i + 1];
+            } else {
+                std::cerr << "Unknown option '" << option << "'" << std::endl;
+                return 1;
+            }
+        }
+    } catch (ConfigurationException &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        std::vector<BatchJob> jobs = BatchRunner::readManifest(manifestFileName);
+        BatchRunner runner(threadCount);
+        std::ofstream outputFile;
+
+        if (!outputFileName.empty()) {
+            outputFile.open(outputFileName);
+
+            if (!outputFile) {
+                std::cerr << "Unable to open " << outputFileName << std::endl;
+                return 1;
+            }
+        }
+
+        // The results are written as JSON lines, so nothing else can be written to stdout while they run
+        Log::setEnabled(false);
+
+        auto start = std::chrono::steady_clock::now();
+        unsigned int failedCount = runner.run(jobs, outputFileName.empty() ? std::cout : outputFile);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cerr << "ROMs: " << jobs.size() << " (" << failedCount << " not ok)" << std::endl;
+        std::cerr << "Threads: " << runner.getThreadCount() << std::endl;
+        std::cerr << "Time: " << elapsed.count() << "s" << std::endl;
+
+        return failedCount > 0 ? 1 : 0;
+    } catch (GeneralException &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "-v") {
+        std::cout << Utils::getVersionString(true) << std::endl;
+        return 0;
+    }
+
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <rom file> [-frames <count>] [-wav|-raw <audio output file>] [-load-state <file>] [-save-state <file>] [-run-ahead <frames>] [-replay <file>] [-sav <file>] [-watch|-watch-read|-watch-write|-break <address>]" << std::endl;
+        std::cout << "       " << argv[0] << " -batch <manifest file> [-threads <count>] [-output <file>]" << std::endl;
+        return 1;
+    }
+
+    if (std::string(argv[1]) == "-batch") {
+        if (argc < 3) {
+            std::cout << "No manifest file given" << std::endl;
+            return 1;
+        }
+
+        return runBatch(argc, argv);
+    }
+
+    return runSingle(argc, argv);
+}
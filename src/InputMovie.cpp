@@ -0,0 +1,172 @@
+#include <iterator>
+#include "InputMovie.h"
+#include "Exceptions.h"
+#include "Utils.h"
+#include "Log.h"
+
+RecordingInputSource::RecordingInputSource(InputSource *source, const std::string &fileName) {
+    this->source = source;
+    this->fileName = fileName;
+
+    file.open(fileName, std::ios::binary | std::ios::trunc);
+
+    if (!file) {
+        throw GeneralException(Utils::implodeString({"Unable to open input recording file '", fileName, "'"}));
+    }
+
+    frameCount = 0;
+    runPortBits = 0;
+    runFlags = 0;
+    runLength = 0;
+    isClosed = false;
+
+    // The frame count is filled in once the recording is closed
+    const char header[INPUT_MOVIE_HEADER_SIZE] = {
+            (char)(INPUT_MOVIE_MAGIC & 0xFF), (char)((INPUT_MOVIE_MAGIC >> 8) & 0xFF),
+            (char)((INPUT_MOVIE_MAGIC >> 16) & 0xFF), (char)((INPUT_MOVIE_MAGIC >> 24) & 0xFF),
+            (char)(INPUT_MOVIE_VERSION & 0xFF), (char)(INPUT_MOVIE_VERSION >> 8),
+            0, 0, 0, 0
+    };
+
+    file.write(header, INPUT_MOVIE_HEADER_SIZE);
+}
+
+RecordingInputSource::~RecordingInputSource() {
+    close();
+}
+
+bool RecordingInputSource::nextFrame(InputFrame &frame) {
+    if (!source->nextFrame(frame)) {
+        return false;
+    }
+
+    if (isClosed) {
+        return true;
+    }
+
+    uint16_t portBits = frame.controls.getPortBits();
+
+    if (runLength > 0 && (portBits != runPortBits || frame.pausePressed)) {
+        writeRun();
+    }
+
+    if (runLength == 0) {
+        runPortBits = portBits;
+        runFlags = frame.pausePressed ? INPUT_MOVIE_FLAG_PAUSE : 0;
+    }
+
+    runLength++;
+    frameCount++;
+
+    return true;
+}
+
+void RecordingInputSource::writeRun() {
+    char run[8];
+    int length = 0;
+    uint32_t value = runLength;
+
+    while (value >= 0x80) {
+        run[length++] = (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+
+    run[length++] = (char)value;
+    run[length++] = (char)(runPortBits & 0xFF);
+    run[length++] = (char)(runPortBits >> 8);
+    run[length++] = (char)runFlags;
+
+    file.write(run, length);
+    runLength = 0;
+}
+
+void RecordingInputSource::close() {
+    if (isClosed) {
+        return;
+    }
+
+    isClosed = true;
+
+    if (runLength > 0) {
+        writeRun();
+    }
+
+    const char count[4] = {
+            (char)(frameCount & 0xFF), (char)((frameCount >> 8) & 0xFF),
+            (char)((frameCount >> 16) & 0xFF), (char)((frameCount >> 24) & 0xFF)
+    };
+
+    file.seekp(6);
+    file.write(count, 4);
+    file.close();
+
+    if (file.fail()) {
+        // Called from the destructor too, so this can only be reported rather than thrown
+        Log::error("Failed to write to input recording file '" + fileName + "'");
+    }
+}
+
+ReplayInputSource::ReplayInputSource(const std::string &fileName) {
+    std::ifstream file(fileName, std::ios::binary);
+
+    if (!file) {
+        throw GeneralException(Utils::implodeString({"Unable to open input recording file '", fileName, "'"}));
+    }
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (data.size() < INPUT_MOVIE_HEADER_SIZE
+        || (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24)) != INPUT_MOVIE_MAGIC) {
+        throw GeneralException(Utils::implodeString({"'", fileName, "' is not an input recording"}));
+    }
+
+    unsigned int version = data[4] | (data[5] << 8);
+
+    if (version != INPUT_MOVIE_VERSION) {
+        throw GeneralException(Utils::implodeString({"Input recording '", fileName, "' is version ", std::to_string(version), ", expected ", std::to_string(INPUT_MOVIE_VERSION)}));
+    }
+
+    frameCount = data[6] | (data[7] << 8) | (data[8] << 16) | ((uint32_t)data[9] << 24);
+    position = INPUT_MOVIE_HEADER_SIZE;
+    runFramesLeft = 0;
+    isPauseLeftInRun = false;
+}
+
+bool ReplayInputSource::nextFrame(InputFrame &frame) {
+    if (runFramesLeft == 0) {
+        uint32_t length = 0;
+        unsigned int shift = 0;
+
+        // A run needs at least its length, the port bits and the flags
+        while (position < data.size() && (data[position] & 0x80) && shift < 28) {
+            length |= (uint32_t)(data[position++] & 0x7F) << shift;
+            shift += 7;
+        }
+
+        if (data.size() - position < 4) {
+            return false;
+        }
+
+        length |= (uint32_t)data[position++] << shift;
+
+        runControls = InputSnapshot::fromPortBits((uint16_t)(data[position] | (data[position + 1] << 8)));
+        isPauseLeftInRun = (data[position + 2] & INPUT_MOVIE_FLAG_PAUSE) != 0;
+        position += 3;
+        runFramesLeft = length;
+
+        if (runFramesLeft == 0) {
+            return false;
+        }
+    }
+
+    frame.controls = runControls;
+    frame.pausePressed = isPauseLeftInRun;
+    isPauseLeftInRun = false;
+    runFramesLeft--;
+
+    return true;
+}
+
+uint32_t ReplayInputSource::getFrameCount() {
+    return frameCount;
+}
@@ -2,14 +2,14 @@
 // Created by Peter Savory on 23/06/2023.
 //
 
-#include "InputInterface.h"
+#include "KeyboardInputInterface.h"
 
-InputInterface::InputInterface(Config *config) {
+KeyboardInputInterface::KeyboardInputInterface(Config *config) {
     playerControls[0] = config->getPlayer1ControlConfig();
     playerControls[1] = config->getPlayer2ControlConfig();
 }
 
-bool InputInterface::isKeyboardKeyPressed(int port, PlayerControlKeyboardConfig::Actions action) {
+bool KeyboardInputInterface::isKeyboardKeyPressed(int port, PlayerControlKeyboardConfig::Actions action) {
 
     if (!playerControls[port]) {
         return false;
@@ -20,32 +20,32 @@ bool InputInterface::isKeyboardKeyPressed(int port, PlayerControlKeyboardConfig:
     return keyboardConfig && sf::Keyboard::isKeyPressed(keyboardConfig->getBind(action));
 }
 
-bool InputInterface::isDPadUpPressed(int port) {
+bool KeyboardInputInterface::isDPadUpPressed(int port) {
     // TODO check for gamepad controls
     return isKeyboardKeyPressed(port, PlayerControlKeyboardConfig::Actions::dPadUp);
 }
 
-bool InputInterface::isDPadDownPressed(int port) {
+bool KeyboardInputInterface::isDPadDownPressed(int port) {
     // TODO check for gamepad controls
     return isKeyboardKeyPressed(port, PlayerControlKeyboardConfig::Actions::dPadDown);
 }
 
-bool InputInterface::isDPadLeftPressed(int port) {
+bool KeyboardInputInterface::isDPadLeftPressed(int port) {
     // TODO check for gamepad controls
     return isKeyboardKeyPressed(port, PlayerControlKeyboardConfig::Actions::dPadLeft);
 }
 
-bool InputInterface::isDPadRightPressed(int port) {
+bool KeyboardInputInterface::isDPadRightPressed(int port) {
     // TODO check for gamepad controls
     return isKeyboardKeyPressed(port, PlayerControlKeyboardConfig::Actions::dPadRight);
 }
 
-bool InputInterface::isButtonAPressed(int port) {
+bool KeyboardInputInterface::isButtonAPressed(int port) {
     // TODO check for gamepad controls
     return isKeyboardKeyPressed(port, PlayerControlKeyboardConfig::Actions::a);
 }
 
-bool InputInterface::isButtonBPressed(int port) {
+bool KeyboardInputInterface::isButtonBPressed(int port) {
     // TODO check for gamepad controls
     return isKeyboardKeyPressed(port, PlayerControlKeyboardConfig::Actions::b);
 }
\ No newline at end of file
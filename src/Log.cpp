@@ -0,0 +1,28 @@
+#include <iostream>
+#include "Log.h"
+
+std::atomic<bool> Log::enabled(true);
+
+std::mutex Log::outputMutex;
+
+void Log::setEnabled(bool enabled) {
+    Log::enabled = enabled;
+}
+
+void Log::message(const std::string &text) {
+    if (!enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << text << std::endl;
+}
+
+void Log::error(const std::string &text) {
+    if (!enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cerr << text << std::endl;
+}
@@ -0,0 +1,55 @@
+#include "Mapper.h"
+#include "Mappers.h"
+
+Mapper *Mapper::create(CartridgeMapper type, Memory *memory, Cartridge *cartridge) {
+    switch (type) {
+        case CartridgeMapper::MapperCodemasters:
+            return new CodemastersMapper(memory, cartridge);
+        case CartridgeMapper::MapperKorean:
+            return new KoreanMapper(memory, cartridge);
+        case CartridgeMapper::MapperKoreanMSX:
+            return new KoreanMSXMapper(memory, cartridge);
+        case CartridgeMapper::MapperNone:
+            return new NoMapper(memory, cartridge);
+        case CartridgeMapper::MapperSega:
+        default:
+            return new SegaMapper(memory, cartridge);
+    }
+}
+
+Mapper::Mapper(CartridgeMapper type, Memory *memory, Cartridge *cartridge) {
+    this->type = type;
+    this->memory = memory;
+    this->cartridge = cartridge;
+
+    for (unsigned char &value : registers) {
+        value = 0x0;
+    }
+}
+
+unsigned long Mapper::getBankOffset(unsigned char bank, unsigned int bankSize) {
+    // The bank mask is for 16KB banks, smaller banks need more bits
+    unsigned long mask = ((cartridge->getBankMask() + 1) * (ROM_BANK_SIZE / bankSize)) - 1;
+
+    return (bank & mask) * bankSize;
+}
+
+void Mapper::saveState(StateWriter &writer) {
+    writer.writeByte(type);
+
+    for (unsigned char &value : registers) {
+        writer.writeByte(value);
+    }
+}
+
+void Mapper::loadState(StateReader &reader) {
+    unsigned char stateType = reader.readByte();
+
+    if (stateType != type) {
+        throw SaveStateException("State is for a cartridge with mapper " + std::to_string(stateType) + ", this cartridge has mapper " + std::to_string(type));
+    }
+
+    for (unsigned char &value : registers) {
+        value = reader.readByte();
+    }
+}
@@ -0,0 +1,143 @@
+#include "Mappers.h"
+
+SegaMapper::SegaMapper(Memory *memory, Cartridge *cartridge) : Mapper(CartridgeMapper::MapperSega, memory, cartridge) {
+
+}
+
+void SegaMapper::reset() {
+    registers[0] = 0;
+    registers[1] = 0;
+    registers[2] = 1;
+    registers[3] = 2;
+
+    memory->setMapperRegisters(0xFFFC, 4);
+    updatePages();
+}
+
+void SegaMapper::write(unsigned short location, unsigned char value) {
+    if (location < 0xFFFC) {
+        return;
+    }
+
+    registers[location - 0xFFFC] = value;
+    updatePages();
+}
+
+void SegaMapper::updatePages() {
+    memory->mapROM(0x0000, 0x400, 0);
+    memory->mapROM(0x0400, 0x3C00, getBankOffset(registers[1], ROM_BANK_SIZE) + 0x400);
+    memory->mapROM(0x4000, 0x4000, getBankOffset(registers[2], ROM_BANK_SIZE));
+
+    // Bit 3 of 0xFFFC switches cartridge RAM in over the bank at 0x8000, and bit 2 selects which RAM bank
+    if (Utils::testBit(3, registers[0])) {
+        memory->mapCartridgeRAM(0x8000, 0x4000, Utils::testBit(2, registers[0]) ? 1 : 0);
+    } else {
+        memory->mapROM(0x8000, 0x4000, getBankOffset(registers[3], ROM_BANK_SIZE));
+    }
+}
+
+CodemastersMapper::CodemastersMapper(Memory *memory, Cartridge *cartridge) : Mapper(CartridgeMapper::MapperCodemasters, memory, cartridge) {
+
+}
+
+void CodemastersMapper::reset() {
+    registers[0] = 0;
+    registers[1] = 1;
+    registers[2] = 2;
+
+    memory->setMapperRegisters(0x0000, 1);
+    memory->setMapperRegisters(0x4000, 1);
+    memory->setMapperRegisters(0x8000, 1);
+    updatePages();
+}
+
+void CodemastersMapper::write(unsigned short location, unsigned char value) {
+    if ((location & 0x3FFF) != 0) {
+        return;
+    }
+
+    registers[location >> 14] = value;
+    updatePages();
+}
+
+void CodemastersMapper::updatePages() {
+    for (int slot = 0; slot < 3; slot++) {
+        memory->mapROM(slot * 0x4000, 0x4000, getBankOffset(registers[slot], ROM_BANK_SIZE));
+    }
+}
+
+KoreanMapper::KoreanMapper(Memory *memory, Cartridge *cartridge) : Mapper(CartridgeMapper::MapperKorean, memory, cartridge) {
+
+}
+
+void KoreanMapper::reset() {
+    registers[0] = 2;
+
+    memory->setMapperRegisters(0xA000, 1);
+    updatePages();
+}
+
+void KoreanMapper::write(unsigned short location, unsigned char value) {
+    if (location != 0xA000) {
+        return;
+    }
+
+    registers[0] = value;
+    updatePages();
+}
+
+void KoreanMapper::updatePages() {
+    memory->mapROM(0x0000, 0x8000, 0);
+    memory->mapROM(0x8000, 0x4000, getBankOffset(registers[0], ROM_BANK_SIZE));
+}
+
+KoreanMSXMapper::KoreanMSXMapper(Memory *memory, Cartridge *cartridge) : Mapper(CartridgeMapper::MapperKoreanMSX, memory, cartridge) {
+
+}
+
+void KoreanMSXMapper::reset() {
+    // Start with the ROM mapped in order, as if there were no mapper
+    registers[0] = 4;
+    registers[1] = 5;
+    registers[2] = 2;
+    registers[3] = 3;
+
+    memory->setMapperRegisters(0x0000, 4);
+    updatePages();
+}
+
+void KoreanMSXMapper::write(unsigned short location, unsigned char value) {
+    if (location > 0x0003) {
+        return;
+    }
+
+    registers[location] = value;
+    updatePages();
+}
+
+void KoreanMSXMapper::updatePages() {
+    // Where each register's 8KB bank is mapped to
+    const unsigned short registerLocations[MAPPER_REGISTER_COUNT] = {0x8000, 0xA000, 0x4000, 0x6000};
+
+    memory->mapROM(0x0000, 0x4000, 0);
+
+    for (int i = 0; i < MAPPER_REGISTER_COUNT; i++) {
+        memory->mapROM(registerLocations[i], 0x2000, getBankOffset(registers[i], 0x2000));
+    }
+}
+
+NoMapper::NoMapper(Memory *memory, Cartridge *cartridge) : Mapper(CartridgeMapper::MapperNone, memory, cartridge) {
+
+}
+
+void NoMapper::reset() {
+    updatePages();
+}
+
+void NoMapper::write(unsigned short, unsigned char) {
+
+}
+
+void NoMapper::updatePages() {
+    memory->mapROM(0x0000, 0xC000, 0);
+}
@@ -1,16 +1,22 @@
-#include <iostream>
 #include "MasterSystem.h"
+#include "Log.h"
 
-MasterSystem::MasterSystem(InputInterface *inputInterface, Config *config) {
+MasterSystem::MasterSystem(InputInterface *inputInterface, SoundConfig *soundConfig, PSGOutputSink *audioOutput) {
     smsCartridge = new Cartridge();
     smsMemory = new Memory(smsCartridge);
     smsVdp = new VDP();
-    smsPSG = new PSG(config->getSoundConfig());
+    smsPSG = new PSG(soundConfig, getCPUCyclesPerSecond(), audioOutput);
     smsInput = new MasterSystemInput(inputInterface);
     z80Io = new MasterSystemZ80IO(smsVdp, smsPSG, smsMemory, smsInput);
     smsCPU = new CPUZ80(smsMemory, z80Io);
     running = false;
-    this->config = config;
+
+    // Every value in a state has a fixed size, so the size can be counted once up front
+    saveStateSize = 0;
+    StateWriter counter(nullptr, 0);
+    writeState(counter);
+    saveStateSize = counter.getSize();
+    loadBackup.resize(saveStateSize);
 }
 
 MasterSystem::~MasterSystem() {
@@ -20,6 +26,7 @@ MasterSystem::~MasterSystem() {
     delete(smsVdp);
     delete(smsPSG);
     delete(z80Io);
+    delete(smsInput);
 }
 
 bool MasterSystem::init(std::string romFilename) {
@@ -27,14 +34,44 @@ bool MasterSystem::init(std::string romFilename) {
     running = true;
     // Load a ROM into memory
     if (!smsCartridge->load(romFilename)) {
-        std::cout<<"Error: Unable to load ROM - exiting."<<std::endl;
+        Log::error("Error: Unable to load ROM - exiting.");
         // TODO: Send some kind of message to the UI (When it exists) to display an error
         return false;
     }
 
+    smsMemory->initMapper();
+
+    // PAL consoles run from a slower master clock, with more scanlines in each frame
+    smsVdp->setVideoStandard(smsCartridge->getVideoStandard());
+    smsPSG->setClockRate(getCPUCyclesPerSecond());
+
     return true;
 }
 
+void MasterSystem::setCartridgeRAMFile(const std::string &fileName) {
+    smsMemory->setCartridgeRAMFile(fileName);
+}
+
+void MasterSystem::setDebugListener(DebugListener *listener) {
+    smsMemory->setDebugListener(listener);
+}
+
+void MasterSystem::addWatchpoint(unsigned short location, bool onRead, bool onWrite) {
+    smsMemory->addWatchpoint(location, onRead, onWrite);
+}
+
+void MasterSystem::addBreakpoint(unsigned short location) {
+    smsMemory->addBreakpoint(location);
+}
+
+void MasterSystem::clearDebugPoints() {
+    smsMemory->clearDebugPoints();
+}
+
+unsigned short MasterSystem::getInstructionAddress() {
+    return smsCPU->getInstructionAddress();
+}
+
 double MasterSystem::tick() {
 
     // TODO - the way that timing works needs to be revamped here, it doesn't seem quite right.
@@ -44,23 +81,44 @@ double MasterSystem::tick() {
 
     smsVdp->execute(machineClicks / 2);
 
-    smsPSG->execute(z80ClockCycles);
+    smsPSG->addCycles(z80ClockCycles);
 
     return machineClicks;
 }
 
+void MasterSystem::finishFrame() {
+    smsPSG->endFrame();
+}
+
 bool MasterSystem::isRunning() {
     return running && smsCPU->getState() != CPUState::Error && smsCPU->getState() != CPUState::Halt;
 }
 
 double MasterSystem::getMachineClicksPerFrame() {
-    return (float)10738580 / 60; // TODO this will need to differ for PAL vs. NTSC
+    if (smsCartridge->getVideoStandard() == VideoStandard::VideoStandardPAL) {
+        return MASTER_SYSTEM_PAL_CLICKS_PER_FRAME;
+    }
+
+    return MASTER_SYSTEM_NTSC_CLICKS_PER_FRAME;
+}
+
+/**
+ * Returns the number of Z80 cycles which are emulated for each second of real time. Console::emulateFrame currently runs
+ * twice the number of machine clicks per frame that the real hardware does, so this needs to take that into account
+ * for anything (such as the PSG) which needs to know how long a cycle lasts.
+ */
+double MasterSystem::getCPUCyclesPerSecond() {
+    return ((getMachineClicksPerFrame() * 2) / 3) * getCurrentFrameRate();
 }
 
-sf::Uint8* MasterSystem::getVideoOutput() {
+uint8_t* MasterSystem::getVideoOutput() {
     return smsVdp->getVideoOutput();
 }
 
+bool MasterSystem::consumeDirtyVideoLines(unsigned short &firstLine, unsigned short &lastLine) {
+    return smsVdp->consumeDirtyLines(firstLine, lastLine);
+}
+
 void MasterSystem::storeUserInput() {
     smsInput->setState();
 }
@@ -69,6 +127,10 @@ void MasterSystem::printVDPInformation() {
     smsVdp->printDebugInfo();
 }
 
+void MasterSystem::printAudioInformation() {
+    smsPSG->printDebugInfo();
+}
+
 unsigned short MasterSystem::getCurrentDisplayWidth() {
     return 256;
 }
@@ -77,10 +139,103 @@ unsigned short MasterSystem::getCurrentDisplayHeight() {
     return smsVdp->getDisplayMode().getActiveDisplayEnd();
 }
 
-unsigned char MasterSystem::getCurrentFrameRate() {
-    return 60; // TODO return 50 if in PAL mode
+double MasterSystem::getCurrentFrameRate() {
+    if (smsCartridge->getVideoStandard() == VideoStandard::VideoStandardPAL) {
+        return MASTER_SYSTEM_PAL_MASTER_CLOCK / MASTER_SYSTEM_PAL_CLICKS_PER_FRAME;
+    }
+
+    return MASTER_SYSTEM_NTSC_MASTER_CLOCK / MASTER_SYSTEM_NTSC_CLICKS_PER_FRAME;
+}
+
+unsigned long MasterSystem::getCompletedFrameCount() {
+    return smsVdp->getFrameCount();
 }
 
 void MasterSystem::sendPauseInterrupt() {
     smsCPU->raisePauseInterrupt();
+}
+
+void MasterSystem::setVideoRenderingEnabled(bool enabled) {
+    smsVdp->setRenderingEnabled(enabled);
+}
+
+void MasterSystem::setAudioMuted(bool muted) {
+    smsPSG->setMuted(muted);
+}
+
+void MasterSystem::setSpeculative(bool speculative) {
+    smsMemory->setSpeculative(speculative);
+    smsPSG->setSpeculative(speculative);
+}
+
+size_t MasterSystem::getSaveStateSize() {
+    return saveStateSize;
+}
+
+size_t MasterSystem::saveState(uint8_t *buffer, size_t capacity) {
+    StateWriter writer(buffer, capacity);
+    writeState(writer);
+
+    return writer.getSize();
+}
+
+void MasterSystem::writeState(StateWriter &writer) {
+    writer.writeLong(SAVE_STATE_MAGIC);
+    writer.writeWord(SAVE_STATE_VERSION);
+    writer.writeLong((uint32_t)saveStateSize);
+
+    smsCPU->saveState(writer);
+    smsMemory->saveState(writer);
+    smsVdp->saveState(writer);
+    smsPSG->saveState(writer);
+    smsInput->saveState(writer);
+}
+
+void MasterSystem::loadState(const uint8_t *buffer, size_t size) {
+    StateReader reader(buffer, size);
+    readHeader(reader, size);
+
+    // Anything else wrong with the state is only found part way through loading it, so the current state is kept to
+    // go back to rather than leaving the machine half loaded
+    saveState(loadBackup.data(), loadBackup.size());
+
+    try {
+        readState(reader);
+    } catch (SaveStateException &) {
+        StateReader backupReader(loadBackup.data(), loadBackup.size());
+        readHeader(backupReader, loadBackup.size());
+        readState(backupReader);
+
+        throw;
+    }
+}
+
+void MasterSystem::restoreState(const uint8_t *buffer, size_t size) {
+    StateReader reader(buffer, size);
+    readHeader(reader, size);
+    readState(reader);
+}
+
+void MasterSystem::readHeader(StateReader &reader, size_t size) {
+    if (reader.readLong() != SAVE_STATE_MAGIC) {
+        throw SaveStateException("Not a save state");
+    }
+
+    unsigned short version = reader.readWord();
+
+    if (version != SAVE_STATE_VERSION) {
+        throw SaveStateException("Unsupported save state version " + std::to_string(version) + " (expected " + std::to_string(SAVE_STATE_VERSION) + ")");
+    }
+
+    if (reader.readLong() != saveStateSize || size != saveStateSize) {
+        throw SaveStateException("Save state is " + std::to_string(size) + " bytes, expected " + std::to_string(saveStateSize));
+    }
+}
+
+void MasterSystem::readState(StateReader &reader) {
+    smsCPU->loadState(reader);
+    smsMemory->loadState(reader);
+    smsVdp->loadState(reader);
+    smsPSG->loadState(reader);
+    smsInput->loadState(reader);
 }
\ No newline at end of file
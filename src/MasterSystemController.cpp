@@ -5,7 +5,7 @@
 #include "MasterSystemController.h"
 
 MasterSystemController::MasterSystemController() {
-    for (int i = 0; i < 5; i++) {
+    for (int i = 0; i < 6; i++) {
         buttons[i] = 0x0;
     }
 }
@@ -3,16 +3,16 @@
 //
 
 #include "MasterSystemInput.h"
-#include "SFML/Window.hpp"
+#include "Utils.h"
 
 MasterSystemInput::MasterSystemInput(InputInterface *inputInterface) {
     this->inputInterface = inputInterface;
+    resetButton = 0x0;
 }
 
 void MasterSystemInput::setState() {
     // TODO allow customisable controls
     resetButton = 0x0;
-    pauseButton = sf::Keyboard::isKeyPressed(sf::Keyboard::Return);
 
     controllers[0].setState(
             inputInterface->isDPadUpPressed(0),
@@ -34,6 +34,41 @@ void MasterSystemInput::setState() {
             );
 }
 
+void MasterSystemInput::saveState(StateWriter &writer) {
+    writer.beginSection(SaveStateSection::SaveStateInput);
+
+    for (auto &controller : controllers) {
+        unsigned char buttons = 0;
+
+        for (int button = MasterSystemControllerButton::dPadUp; button <= MasterSystemControllerButton::buttonB; button++) {
+            buttons |= controller.getButtonValue((MasterSystemControllerButton)button) << button;
+        }
+
+        writer.writeByte(buttons);
+    }
+
+    writer.writeByte(resetButton);
+}
+
+void MasterSystemInput::loadState(StateReader &reader) {
+    reader.beginSection(SaveStateSection::SaveStateInput);
+
+    for (auto &controller : controllers) {
+        unsigned char buttons = reader.readByte();
+
+        controller.setState(
+                Utils::testBit(MasterSystemControllerButton::dPadUp, buttons),
+                Utils::testBit(MasterSystemControllerButton::dPadDown, buttons),
+                Utils::testBit(MasterSystemControllerButton::dPadLeft, buttons),
+                Utils::testBit(MasterSystemControllerButton::dPadRight, buttons),
+                Utils::testBit(MasterSystemControllerButton::buttonA, buttons),
+                Utils::testBit(MasterSystemControllerButton::buttonB, buttons)
+                );
+    }
+
+    resetButton = reader.readByte() & 1;
+}
+
 unsigned char MasterSystemInput::readPortDC() {
     return ~ (
             controllers[0].getButtonValue(MasterSystemControllerButton::dPadUp) +
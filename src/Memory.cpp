@@ -7,12 +7,26 @@ Master System memory map:
 0xE000-0xFFFF : Mirrored RAM
  */
 #include <iostream>
+#include <vector>
 #include "Cartridge.h"
 #include "Memory.h"
+#include "Mapper.h"
 #include "Utils.h"
 
+namespace {
+    // Read past the end of the ROM
+    const std::vector<unsigned char> emptyPage(MEMORY_PAGE_SIZE, 0x0);
+
+    // Read from ROM while the cartridge slot is disabled
+    const std::vector<unsigned char> disabledPage(MEMORY_PAGE_SIZE, 0xFF);
+}
+
 Memory::Memory(Cartridge *cart) {
     smsCartridge = cart;
+    mapper = nullptr;
+    debugListener = nullptr;
+    isSpeculative = false;
+    hasAnyBreakpoints = false;
     controlRegister = 0xBF; // Enable cartridge slot by default for now // TODO enable BIOS if one is detected
 
     // Clear memory
@@ -20,74 +34,102 @@ Memory::Memory(Cartridge *cart) {
         i = 0x0;
     }
 
-    // Clear RAM banks
-    for (auto &bank: ramBank) {
-        for (unsigned char &i: bank) {
-            i = 0x0;
+    for (unsigned int page = 0; page < MEMORY_PAGE_COUNT; page++) {
+        unsigned short location = page << MEMORY_PAGE_SHIFT;
+        readFlags[page] = 0;
+        writeFlags[page] = 0;
+        breakpointPages[page] = false;
+
+        if (location < 0xC000) {
+            continue;
         }
-    }
 
-    for (unsigned short &memoryPage: memoryPages) {
-        memoryPage = 0x0;
+        // Both copies of the RAM are the same memory, so the mirror never needs updating
+        readPages[page] = &ram[location & (MEMORY_RAM_SIZE - 1)];
+        writePages[page] = &ram[location & (MEMORY_RAM_SIZE - 1)];
     }
-    memoryPages[1] = 1;
-    memoryPages[2] = 2;
 
-    ramBanked = false;
-    currentPage3RamBank = -1;
+    // Until a cartridge is loaded, this maps in empty ROM
+    initMapper();
 }
 
-Memory::~Memory() = default;
+Memory::~Memory() {
+    delete(mapper);
+}
 
-/**
- * [read Read from system memory]
- * @param  location [Memory location to read from]
- * @return          [Value within memory at location]
- */
-unsigned char Memory::read(unsigned short location) {
-    // Handle mirroring
-    if (location >= 0xFFFC) {
-        location -= 0x2000;
-    }
+void Memory::initMapper() {
+    delete(mapper);
 
-    if (!smsCartridge->isCodemasters() && location < 0x400) {
-        return readMedia(location);
+    for (unsigned char &flags : writeFlags) {
+        flags &= ~MemoryPageFlags::MemoryPageMapperRegisters;
     }
 
-    if (location < 0x4000) {
-        // Page 1
-        unsigned long address = location + (0x4000 * memoryPages[0]);
-        return readMedia(address);
-    }
+    mapperRegisters.reset();
+    writeFlaggedLocations = writeWatchpoints;
 
-    if (location < 0x8000) {
-        // Page 2
-        unsigned long address = location + (0x4000 * memoryPages[1]);
-        address -= 0x4000; // Remove offset
-        return readMedia(address);
-    }
+    mapper = Mapper::create(smsCartridge->getMapper(), this, smsCartridge);
+    mapper->reset();
+}
+
+void Memory::mapROM(unsigned short location, unsigned int length, unsigned long romOffset) {
+    bool isEnabled = isCartridgeSlotEnabled();
 
-    if (location < 0xC000) {
-        // Page 3 (or extra RAM)
-        if (currentPage3RamBank >= 0) {
-            return ramBank[currentPage3RamBank][location - 0x8000];
+    for (unsigned int offset = 0; offset < length; offset += MEMORY_PAGE_SIZE) {
+        unsigned int page = (location + offset) >> MEMORY_PAGE_SHIFT;
+        const unsigned char *rom = smsCartridge->getROM(romOffset + offset);
+
+        if (!isEnabled) {
+            // TODO allow reading from BIOS, also determine which priority these should be if multiple flags are turned on
+            readPages[page] = disabledPage.data();
+        } else {
+            readPages[page] = rom != nullptr ? rom : emptyPage.data();
         }
 
-        unsigned long address = location + (0x4000 * memoryPages[2]);
-        address -= 0x8000;
-        return readMedia(address);
+        writePages[page] = discardPage;
     }
+}
+
+void Memory::mapCartridgeRAM(unsigned short location, unsigned int length, unsigned int bank) {
+    // TODO should the media/memory control register effect this also for when attempting to write to CART RAM?
+    cartridgeRAM.use();
+    unsigned char *bankData = cartridgeRAM.getBank(bank);
 
-    return ram[location];
+    for (unsigned int offset = 0; offset < length; offset += MEMORY_PAGE_SIZE) {
+        unsigned int page = (location + offset) >> MEMORY_PAGE_SHIFT;
+
+        readPages[page] = &bankData[offset];
+        writePages[page] = &bankData[offset];
+    }
+}
+
+void Memory::setCartridgeRAMFile(const std::string &fileName) {
+    cartridgeRAM.setSaveFile(fileName);
+
+    // The RAM has moved, so it needs mapping in again if it's in use
+    mapper->updatePages();
+}
+
+void Memory::setSpeculative(bool speculative) {
+    isSpeculative = speculative;
+    cartridgeRAM.setSpeculative(speculative);
+
+    // The cartridge RAM has moved
+    mapper->updatePages();
 }
 
-unsigned char Memory::readMedia(unsigned long location) {
-    // TODO allow reading from BIOS, also determine which priority these should be if multiple flags are turned on
-    if (!Utils::testBit(MemoryControlRegisterFlags::enableCartridgeSlot, controlRegister)) {
-        return smsCartridge->read(location);
+void Memory::setMapperRegisters(unsigned short location, unsigned int length) {
+    for (unsigned int offset = 0; offset < length; offset++) {
+        mapperRegisters[location + offset] = true;
+        writeFlaggedLocations[location + offset] = true;
+    }
+
+    for (unsigned int page = location >> MEMORY_PAGE_SHIFT; page <= (location + length - 1u) >> MEMORY_PAGE_SHIFT; page++) {
+        writeFlags[page] |= MemoryPageFlags::MemoryPageMapperRegisters;
     }
+}
 
-    return 0xFF;
+bool Memory::isCartridgeSlotEnabled() {
+    return !Utils::testBit(MemoryControlRegisterFlags::enableCartridgeSlot, controlRegister);
 }
 
 unsigned short Memory::read16Bit(unsigned short location) {
@@ -99,110 +141,107 @@ void Memory::write(unsigned short location, unsigned short value) {
     write(location+1, (unsigned char)(value >> 8));
 }
 
-/**
- * [write Writes to system memory]
- * @param location [Memory location to write to]
- * @param value    [The byte to write]
- */
-void Memory::write(unsigned short location, unsigned char value) {
-
-    handleMemoryPaging(location, value);
+unsigned char Memory::readFlaggedPage(unsigned short location) {
+    unsigned char value = readPages[location >> MEMORY_PAGE_SHIFT][location & MEMORY_PAGE_MASK];
 
-    if (location < 0x8000) {
-        // Attempting to write to ROM, disallow this...
-        return;
+    if (readWatchpoints[location] && debugListener != nullptr && !isSpeculative) {
+        debugListener->onWatchpoint(location, value, false);
     }
 
-    if (location < 0xC000) {
-        // Allow a write if RAM is banked into this address range
-        // TODO should the media/memory control register effect this also for when attempting to write to CART RAM?
-        if (currentPage3RamBank < 0) {
-            return;
-        }
-
-        ramBank[currentPage3RamBank][location - 0x8000] = value;
-        return;
-    }
+    return value;
+}
 
-    // If we've reached this point, it's all good to write to RAM
-    ram[location] = value;
+void Memory::writeFlaggedPage(unsigned short location, unsigned char value) {
+    unsigned int page = location >> MEMORY_PAGE_SHIFT;
 
-    // Handle mirrored addresses
-    if (location >= 0xC000 && location < 0xDFFC) {
-        ram[location - 0x2000] = value;
-        return;
+    if (writeWatchpoints[location] && debugListener != nullptr && !isSpeculative) {
+        debugListener->onWatchpoint(location, value, true);
     }
 
-    if (location >= 0xE000) {
-        ram[location - 0x2000] = value;
-        return;
+    // Watched locations can be on the same page as the registers, so only the registers themselves go to the mapper
+    if (mapperRegisters[location]) {
+        mapper->write(location, value);
     }
 
+    // Mapper registers which are also RAM (0xFFFC-0xFFFF) are written to both, and reads give the RAM
+    writePages[page][location & MEMORY_PAGE_MASK] = value;
 }
 
-/**
- * [Memory::memoryPage Perform a memory page operation]
- * @param Codemasters [Whether the game is codemasters or not]
- */
-void Memory::handleMemoryPaging(unsigned short location, unsigned char value) {
+void Memory::setDebugListener(DebugListener *listener) {
+    debugListener = listener;
+}
 
-    if (!smsCartridge->isCodemasters()) {
+void Memory::addWatchpoint(unsigned short location, bool onRead, bool onWrite) {
+    unsigned int page = location >> MEMORY_PAGE_SHIFT;
 
-        if (location < 0xFFFC) {
-            return;
-        }
+    if (onRead) {
+        readWatchpoints[location] = true;
+        readFlags[page] |= MemoryPageFlags::MemoryPageWatched;
+    }
 
-        unsigned short page = value & smsCartridge->getBankMask();
-
-        switch (location) {
-            case 0xFFFC:
-                if (Utils::testBit(3, value)) {
-                    if (Utils::testBit(2, value)) {
-                        currentPage3RamBank = 1;
-                    } else {
-                        currentPage3RamBank = 0;
-                    }
-                } else {
-                    currentPage3RamBank = -1;
-                }
-                break;
-            case 0xFFFD:
-                memoryPages[0] = page;
-                break;
-            case 0xFFFE:
-                memoryPages[1] = page;
-                break;
-            case 0xFFFF:
-                // ROM banking in slot 3 - Only allow if there is no RAM there
-                if (!Utils::testBit(3, ram[0xFFFC])) {
-                    memoryPages[2] = page;
-                }
-                break;
-            default:
-                break;
-        }
-        return;
+    if (onWrite) {
+        writeWatchpoints[location] = true;
+        writeFlaggedLocations[location] = true;
+        writeFlags[page] |= MemoryPageFlags::MemoryPageWatched;
     }
+}
 
-    if (location == 0x0 || location == 0x4000 || location == 0x8000) {
-        unsigned short page = value & smsCartridge->getBankMask();
-
-        switch (location) {
-            case 0x0:
-                memoryPages[0] = page;
-                break;
-            case 0x4000:
-                memoryPages[1] = page;
-                break;
-            case 0x8000:
-                memoryPages[2] = page;
-                break;
-            default:
-                break;
-        }
+void Memory::addBreakpoint(unsigned short location) {
+    breakpoints[location] = true;
+    breakpointPages[location >> MEMORY_PAGE_SHIFT] = true;
+    hasAnyBreakpoints = true;
+}
+
+void Memory::clearDebugPoints() {
+    readWatchpoints.reset();
+    writeWatchpoints.reset();
+    breakpoints.reset();
+    hasAnyBreakpoints = false;
+    writeFlaggedLocations = mapperRegisters;
+
+    for (unsigned int page = 0; page < MEMORY_PAGE_COUNT; page++) {
+        readFlags[page] &= ~MemoryPageFlags::MemoryPageWatched;
+        writeFlags[page] &= ~MemoryPageFlags::MemoryPageWatched;
+        breakpointPages[page] = false;
+    }
+}
+
+void Memory::checkBreakpoint(unsigned short location) {
+    if (breakpoints[location] && debugListener != nullptr && !isSpeculative) {
+        debugListener->onBreakpoint(location);
     }
 }
 
 void Memory::writeMediaControlRegister(unsigned char value) {
     controlRegister = value;
+
+    // Enabling or disabling the cartridge slot changes what's mapped in
+    mapper->updatePages();
+}
+
+void Memory::saveState(StateWriter &writer) {
+    writer.beginSection(SaveStateSection::SaveStateMemory);
+
+    writer.writeBlock(ram, MEMORY_RAM_SIZE);
+
+    writer.writeBlock(cartridgeRAM.getData(), CARTRIDGE_RAM_SIZE);
+
+    mapper->saveState(writer);
+
+    writer.writeByte(controlRegister);
+}
+
+void Memory::loadState(StateReader &reader) {
+    reader.beginSection(SaveStateSection::SaveStateMemory);
+
+    reader.readBlock(ram, MEMORY_RAM_SIZE);
+
+    // The RAM can be mapped from the save file, which would otherwise be rewritten on every rewind and run-ahead frame
+    reader.readChangedBlock(cartridgeRAM.getData(), CARTRIDGE_RAM_SIZE);
+
+    mapper->loadState(reader);
+
+    controlRegister = reader.readByte();
+
+    mapper->updatePages();
 }
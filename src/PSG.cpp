@@ -1,13 +1,12 @@
 #include "PSG.h"
 #include "Utils.h"
 #include <cmath>
+#include <algorithm>
+#include <iostream>
 
-PSG::PSG(SoundConfig *soundConfig) {
+PSG::PSG(SoundConfig *soundConfig, double cpuClockRate, PSGOutputSink *outputSink) {
 
-    outputBuffer = new sf::SoundBuffer();
-    outputSound = new sf::Sound();
-    outputSound->setBuffer(*outputBuffer);
-    outputSound->setVolume((float)soundConfig->getVolume());
+    this->outputSink = outputSink;
 
     // Initialise channels
     channels[PSGChannelIndex::Tone0] = new PSGChannel(false);
@@ -28,16 +27,26 @@ PSG::PSG(SoundConfig *soundConfig) {
     selectedRegister = 0;
     hasSelectedVolumeRegister = false;
 
-    cycles = 0;
-    clockInfo = 0;
+    noiseShiftRegister = NOISE_SHIFT_REGISTER_RESET;
+    channels[PSGChannelIndex::Noise]->polarity = -1;
+    generateNoiseRunLengths();
 
-    clearBuffer();
+    blockTime = 0;
+    synthesizedTime = 0;
 
-    bufferUpdateLimit = ((float)PSG_CLOCK_SPEED / (((float)SAMPLE_RATE / (float)BUFFER_SIZE) + 1)) / (float)BUFFER_SIZE;
+    averageFillLevel = outputSink->getTargetFillLevel();
+    rateAdjustment = 1.0;
+    isMuted = false;
+    isSpeculative = false;
 
-    currentBufferUpdates = 0;
+    for (auto &sample : buffer) {
+        sample = 0;
+    }
 
     this->soundConfig = soundConfig;
+
+    synth = nullptr;
+    setClockRate(cpuClockRate);
 }
 
 PSG::~PSG() {
@@ -45,50 +54,62 @@ PSG::~PSG() {
         delete(channel);
     }
 
-    delete(outputSound);
-    delete(outputBuffer);
+    delete(synth);
 }
 
-void PSG::execute(float soundCycles) {
-
-    if (!soundConfig->isEnabled()) {
-        return;
-    }
-
-    const int sampleRate = 16;
-
-    soundCycles /= sampleRate;
+void PSG::setClockRate(double cpuClockRate) {
+    clockDivider = std::max(1, (int)std::lround(cpuClockRate / PSG_CLOCK_SPEED));
 
-    cycles += soundCycles;
+    // The synth needs room for slightly more than one block, as a block can overrun by part of an instruction
+    delete(synth);
+    synth = new BandLimitedBuffer(soundConfig->getSampleRate(), cpuClockRate, BUFFER_SIZE * 2);
+    synth->setRateAdjustment(rateAdjustment);
+    blockLength = synth->getClocksForSamples(BUFFER_SIZE);
+}
 
-    float floor = floorf(cycles);
-    currentBufferUpdates += floor ;
-    clockInfo += floor;
+void PSG::endFrame() {
 
-    cycles -= floor;
+    if (!isSynthesizing()) {
+        blockTime = 0;
+        return;
+    }
 
-    unsigned short bufferValue = 0;
+    synthesize();
+    endBlock(blockTime);
 
-    for (int i = 0; i < 3; i++) {
-        bufferValue += emulateTone(floor, i);
+    // Output which isn't being played back mustn't depend on timing outside of the emulator
+    if (outputSink->isRealTime() && !isMuted) {
+        updateRateControl();
     }
+}
 
-    if (currentBufferUpdates < bufferUpdateLimit) {
-        return;
-    }
+void PSG::updateRateControl() {
+    // Smooth out the fill level, as it jumps by a whole chunk each time the audio thread takes more samples
+    averageFillLevel += ((double)outputSink->getFillLevel() - averageFillLevel) * 0.05;
 
-    if (currentBufferLocation >= BUFFER_SIZE) {
-        playBuffer();
-    }
+    // 0 when empty, 0.5 at the target level and 1 when twice as full as the target
+    double fill = std::min(averageFillLevel / (outputSink->getTargetFillLevel() * 2), 1.0);
 
-    buffer[currentBufferLocation] = bufferValue;
+    // Generate more samples when the buffer is running low, and fewer when it's filling up
+    rateAdjustment = 1.0 + (RATE_CONTROL_MAX_ADJUSTMENT * (1.0 - (2.0 * fill)));
+    synth->setRateAdjustment(rateAdjustment);
+}
 
-    ++currentBufferLocation;
-    currentBufferUpdates = bufferUpdateLimit - currentBufferUpdates;
+double PSG::getAverageFillLevel() {
+    return averageFillLevel;
+}
 
+double PSG::getRateAdjustment() {
+    return rateAdjustment;
 }
 
 void PSG::write(unsigned char data) {
+
+    if (isSynthesizing()) {
+        // Render everything since the last change in one go, so that this change happens at the right time
+        synthesize();
+    }
+
     if (Utils::testBit(7, data)) {
         // Program is trying to select and update a new sound channel
         selectedRegister = (data & 0x60) >> 5;
@@ -110,35 +131,247 @@ void PSG::write(unsigned char data) {
 
 
     }
+
+    if (selectedRegister == PSGChannelIndex::Noise && !hasSelectedVolumeRegister) {
+        // Any write to the noise register resets the shift register
+        noiseShiftRegister = NOISE_SHIFT_REGISTER_RESET;
+        channels[PSGChannelIndex::Noise]->polarity = (noiseShiftRegister & 1) ? 1 : -1;
+    }
+
+    if (isSynthesizing()) {
+        updateAmplitude(channels[selectedRegister], blockTime);
+    }
 }
 
-void PSG::playBuffer() {
-    outputBuffer->loadFromSamples(buffer, BUFFER_SIZE, 1, SAMPLE_RATE);
-    outputSound->setBuffer(*outputBuffer);
-    outputSound->play();
-    currentBufferLocation = 0;
+void PSG::synthesize() {
+
+    // Finish any complete blocks first, so that the synth never has to hold more than one block of samples
+    while (blockTime >= blockLength) {
+        runChannels(blockLength);
+        endBlock(blockLength);
+    }
+
+    if (synthesizedTime == blockTime) {
+        return;
+    }
+
+    runChannels(blockTime);
+    synthesizedTime = blockTime;
 }
 
-void PSG::clearBuffer() {
-    for(int i = 0; i < BUFFER_SIZE; i++) {
-        buffer[i] = 0;
+void PSG::runChannels(unsigned int endTime) {
+    for (int i = 0; i < 3; i++) {
+        runTone(channels[i], endTime);
     }
+
+    runNoise(endTime);
 }
 
-unsigned short PSG::emulateTone(float floor, int channelNumber) {
+void PSG::runTone(PSGChannel *channel, unsigned int endTime) {
 
-    PSGChannel* channel = channels[channelNumber];
+    if (channel->getFrequency() <= 1) {
+        // A tone value of 0 or 1 holds the output high, games use this to play samples by changing the volume
+        channel->nextTransitionTime = std::min(channel->nextTransitionTime, endTime);
 
-    if (channel->getFrequency() == 0) {
-        return 0;
+        if (channel->polarity != 1) {
+            channel->polarity = 1;
+            updateAmplitude(channel, channel->nextTransitionTime);
+        }
+
+        channel->nextTransitionTime = endTime;
+        return;
     }
 
-    channel->counter -= floor;
+    // The counter is reloaded with the tone value and the output flips each time it reaches zero
+    unsigned int period = channel->getFrequency() * clockDivider;
 
-    if (channel->counter <= 0) {
-        channel->counter = channel->getFrequency();
+    while (channel->nextTransitionTime < endTime) {
         channel->polarity = -channel->polarity;
+        updateAmplitude(channel, channel->nextTransitionTime);
+        channel->nextTransitionTime += period;
     }
+}
+
+/**
+ * The noise channel's shift register is shifted once every time its counter reaches zero twice. Rather than stepping
+ * it one shift at a time, this works out how many shifts it'll take for the output bit to change, and jumps straight
+ * to that point - so the cost is per change in output, the same as the tone channels.
+ */
+void PSG::runNoise(unsigned int endTime) {
+    PSGChannel *channel = channels[PSGChannelIndex::Noise];
+    unsigned int period = getNoiseShiftPeriod();
+
+    while (channel->nextTransitionTime < endTime) {
+        // The shift which changes the output bit
+        unsigned int runLength = getNoiseRunLength();
+        unsigned int changeTime = channel->nextTransitionTime + ((runLength - 1) * period);
+
+        if (changeTime >= endTime) {
+            // The output doesn't change before the end time, so just apply the shifts that happen before then
+            unsigned int shifts = ((endTime - channel->nextTransitionTime) + period - 1) / period;
+            shiftNoise(shifts);
+            channel->nextTransitionTime += shifts * period;
+            return;
+        }
+
+        shiftNoise(runLength);
+        channel->nextTransitionTime = changeTime + period;
+
+        channel->polarity = (noiseShiftRegister & 1) ? 1 : -1;
+        updateAmplitude(channel, changeTime);
+    }
+}
+
+/**
+ * Returns the number of CPU cycles between each shift of the noise shift register
+ */
+unsigned int PSG::getNoiseShiftPeriod() {
+    unsigned int counterReload;
+
+    switch (channels[PSGChannelIndex::Noise]->getFrequency() & 0x3) {
+        case 0:
+            counterReload = 0x10;
+            break;
+        case 1:
+            counterReload = 0x20;
+            break;
+        case 2:
+            counterReload = 0x40;
+            break;
+        default:
+            // Clocked by tone channel 2 instead of its own counter
+            counterReload = std::max(channels[PSGChannelIndex::Tone2]->getFrequency(), (unsigned short)1);
+            break;
+    }
+
+    // The register shifts on every other time the counter reaches zero
+    return counterReload * 2 * clockDivider;
+}
+
+unsigned int PSG::getNoiseRunLength() {
+    unsigned int runLength = noiseRunLengths[noiseShiftRegister & 0xFF];
+
+    if (runLength == 8 && ((noiseShiftRegister >> 8) & 1) == (noiseShiftRegister & 1)) {
+        // The run carries on into the high byte
+        runLength += noiseRunLengths[noiseShiftRegister >> 8];
+    }
+
+    return runLength;
+}
 
-    return volumeTable[channel->getVolume()] * channel->polarity;
+/**
+ * Shifts the noise shift register a number of times at once. White noise feeds back bits 0 and 3 (the Master System's
+ * taps) XORed together, periodic noise feeds back bit 0. Up to 13 shifts can be worked out at once for white noise,
+ * as after that the feedback depends on bits which have themselves been fed back.
+ */
+void PSG::shiftNoise(unsigned int shifts) {
+    bool isWhiteNoise = Utils::testBit(2, (unsigned char)channels[PSGChannelIndex::Noise]->getFrequency());
+
+    while (shifts > 0) {
+        unsigned int count = std::min(shifts, 13u);
+        unsigned int value = noiseShiftRegister;
+        unsigned int feedback = isWhiteNoise ? (value ^ (value >> 3)) : value;
+
+        feedback &= (1u << count) - 1;
+
+        noiseShiftRegister = (unsigned short)((value >> count) | (feedback << (16 - count)));
+        shifts -= count;
+    }
+}
+
+void PSG::generateNoiseRunLengths() {
+    for (unsigned int value = 0; value < 256; value++) {
+        unsigned char runLength = 1;
+
+        while (runLength < 8 && ((value >> runLength) & 1) == (value & 1)) {
+            runLength++;
+        }
+
+        noiseRunLengths[value] = runLength;
+    }
+}
+
+void PSG::updateAmplitude(PSGChannel *channel, unsigned int time) {
+    int amplitude = volumeTable[channel->getVolume()] * channel->polarity;
+
+    synth->addDelta(time, amplitude - channel->amplitude);
+    channel->amplitude = amplitude;
+}
+
+void PSG::endBlock(unsigned int length) {
+    synth->endFrame(length);
+
+    // Channel times are relative to the start of the block, so move them along to the start of the next one
+    for (auto &channel : channels) {
+        channel->nextTransitionTime -= length;
+    }
+
+    blockTime -= length;
+    synthesizedTime = 0;
+
+    unsigned int sampleCount;
+
+    while ((sampleCount = synth->readSamples(buffer, BUFFER_SIZE)) > 0) {
+
+        if (!isMuted) {
+            outputSink->write(buffer, sampleCount);
+        }
+    }
+}
+
+void PSG::saveState(StateWriter &writer) {
+    writer.beginSection(SaveStateSection::SaveStatePSG);
+
+    for (auto &channel : channels) {
+        channel->saveState(writer);
+    }
+
+    writer.writeByte(selectedRegister);
+    writer.writeBool(hasSelectedVolumeRegister);
+    writer.writeWord(noiseShiftRegister);
+    writer.writeLong(blockTime);
+    writer.writeLong(synthesizedTime);
+}
+
+void PSG::loadState(StateReader &reader) {
+    reader.beginSection(SaveStateSection::SaveStatePSG);
+
+    for (auto &channel : channels) {
+        channel->loadState(reader);
+    }
+
+    selectedRegister = reader.readByte() & 0x3;
+    hasSelectedVolumeRegister = reader.readBool();
+    noiseShiftRegister = reader.readWord();
+
+    // The synth only has room for a little over one block, so these can't be any further along than that
+    blockTime = std::min(reader.readLong(), blockLength);
+    synthesizedTime = std::min(reader.readLong(), blockTime);
+
+    if (isSynthesizing()) {
+        for (auto &channel : channels) {
+            updateAmplitude(channel, synthesizedTime);
+        }
+    }
+}
+
+void PSG::setMuted(bool muted) {
+    isMuted = muted;
+}
+
+void PSG::setSpeculative(bool speculative) {
+    isSpeculative = speculative;
+}
+
+bool PSG::isSynthesizing() {
+    return soundConfig->isEnabled() && !isSpeculative;
+}
+
+void PSG::printDebugInfo() {
+    outputSink->printDebugInfo();
+
+    if (outputSink->isRealTime()) {
+        std::cout << "Audio stream average fill level: " << averageFillLevel << " samples (target " << outputSink->getTargetFillLevel() << ")" << std::endl;
+        std::cout << "Audio rate adjustment: " << rateAdjustment << std::endl;
+    }
 }
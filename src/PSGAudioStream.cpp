@@ -0,0 +1,86 @@
+#include <iostream>
+#include "PSGAudioStream.h"
+
+PSGAudioStream::PSGAudioStream(unsigned int sampleRate) :
+        targetFillLevel((size_t)sampleRate * AUDIO_STREAM_TARGET_LATENCY_MS / 1000),
+        ringBuffer(targetFillLevel * 4) {
+    lastSample = 0;
+    isStarted = false;
+    underrunCount = 0;
+    overrunCount = 0;
+
+    chunk.resize(targetFillLevel / 2, 0);
+
+    initialize(1, sampleRate);
+}
+
+PSGAudioStream::~PSGAudioStream() {
+    stop();
+}
+
+void PSGAudioStream::write(const int16_t *samples, size_t count) {
+    size_t written = ringBuffer.push(samples, count);
+
+    if (written < count) {
+        ++overrunCount;
+    }
+
+    // Wait until the buffer has filled up to the target level before starting, otherwise playback would begin with an underrun
+    if (!isStarted && ringBuffer.size() >= targetFillLevel) {
+        play();
+        isStarted = true;
+    }
+}
+
+bool PSGAudioStream::onGetData(sf::SoundStream::Chunk &data) {
+    // Called from SFML's audio thread
+    size_t count = ringBuffer.pop(chunk.data(), chunk.size());
+
+    if (count > 0) {
+        lastSample = chunk[count - 1];
+    }
+
+    if (count < chunk.size()) {
+        // Not enough samples have been generated - hold the last sample rather than dropping to zero, which would click
+        ++underrunCount;
+
+        for (size_t i = count; i < chunk.size(); i++) {
+            chunk[i] = lastSample;
+        }
+    }
+
+    data.samples = chunk.data();
+    data.sampleCount = chunk.size();
+
+    // Always keep the stream going, as it is fed for as long as the emulator is running
+    return true;
+}
+
+void PSGAudioStream::onSeek(sf::Time) {
+    // Seeking isn't possible in a live stream
+}
+
+size_t PSGAudioStream::getFillLevel() {
+    return ringBuffer.size();
+}
+
+size_t PSGAudioStream::getTargetFillLevel() {
+    return targetFillLevel;
+}
+
+unsigned long PSGAudioStream::getUnderrunCount() {
+    return underrunCount;
+}
+
+unsigned long PSGAudioStream::getOverrunCount() {
+    return overrunCount;
+}
+
+bool PSGAudioStream::isRealTime() {
+    return true;
+}
+
+void PSGAudioStream::printDebugInfo() {
+    std::cout << "Audio stream underruns: " << underrunCount << std::endl;
+    std::cout << "Audio stream overruns: " << overrunCount << std::endl;
+}
@@ -10,7 +10,8 @@ PSGChannel::PSGChannel(bool isNoiseChannel) {
     frequency = 0x0;
 
     polarity = 1;
-    counter = 0;
+    nextTransitionTime = 0;
+    amplitude = 0;
 }
 
 unsigned short PSGChannel::getFrequency() {
@@ -25,6 +26,20 @@ unsigned char PSGChannel::getVolume() {
     return volume;
 }
 
+void PSGChannel::saveState(StateWriter &writer) {
+    writer.writeByte(volume);
+    writer.writeWord(frequency);
+    writer.writeLong(nextTransitionTime);
+    writer.writeByte(polarity < 0 ? 0 : 1);
+}
+
+void PSGChannel::loadState(StateReader &reader) {
+    volume = reader.readByte() & 0xF;
+    frequency = reader.readWord() & (isNoiseChannel ? 0xF : 0x3FF);
+    nextTransitionTime = reader.readLong();
+    polarity = reader.readByte() == 0 ? -1 : 1;
+}
+
 void PSGChannel::setFrequencyLower(unsigned char value) {
 
     if (isNoiseChannel) {
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <iostream>
+#include "PSGWaveFileWriter.h"
+#include "Exceptions.h"
+#include "Utils.h"
+#include "Log.h"
+
+/**
+ * Appends a value to a block of bytes in little-endian order, whatever the host's byte order is
+ */
+static void appendLittleEndian(std::vector<char> &block, unsigned int value, unsigned int byteCount) {
+    for (unsigned int i = 0; i < byteCount; i++) {
+        block.push_back((char)((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static void appendTag(std::vector<char> &block, const char *tag) {
+    block.insert(block.end(), tag, tag + 4);
+}
+
+PSGWaveFileWriter::PSGWaveFileWriter(const std::string &fileName, unsigned int sampleRate, bool isRaw) {
+    this->fileName = fileName;
+    this->isRaw = isRaw;
+    isClosing = false;
+    isClosed = false;
+    hasWriteFailed = false;
+    dataSize = 0;
+
+    file.open(fileName, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        throw GeneralException(Utils::implodeString({"Unable to open audio output file '", fileName, "'"}));
+    }
+
+    pendingBlock.reserve(WAVE_WRITER_BLOCK_SIZE);
+
+    if (!isRaw) {
+        writeHeader(sampleRate);
+    }
+
+    writerThread = std::thread(&PSGWaveFileWriter::runWriterThread, this);
+}
+
+PSGWaveFileWriter::~PSGWaveFileWriter() {
+    close();
+}
+
+void PSGWaveFileWriter::writeHeader(unsigned int sampleRate) {
+    const unsigned int channels = 1;
+    const unsigned int bytesPerSample = 2;
+
+    // The RIFF and data chunk sizes aren't known yet, they are filled in by close()
+    appendTag(pendingBlock, "RIFF");
+    appendLittleEndian(pendingBlock, 0, 4);
+    appendTag(pendingBlock, "WAVE");
+
+    appendTag(pendingBlock, "fmt ");
+    appendLittleEndian(pendingBlock, 16, 4);
+    appendLittleEndian(pendingBlock, 1, 2); // PCM
+    appendLittleEndian(pendingBlock, channels, 2);
+    appendLittleEndian(pendingBlock, sampleRate, 4);
+    appendLittleEndian(pendingBlock, sampleRate * channels * bytesPerSample, 4);
+    appendLittleEndian(pendingBlock, channels * bytesPerSample, 2);
+    appendLittleEndian(pendingBlock, bytesPerSample * 8, 2);
+
+    appendTag(pendingBlock, "data");
+    appendLittleEndian(pendingBlock, 0, 4);
+}
+
+void PSGWaveFileWriter::write(const int16_t *samples, size_t count) {
+
+    if (isClosed) {
+        return;
+    }
+
+    if (hasWriteFailed) {
+        throw GeneralException(Utils::implodeString({"Failed to write to audio output file '", fileName, "'"}));
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        appendLittleEndian(pendingBlock, (unsigned short)samples[i], 2);
+    }
+
+    dataSize += count * 2;
+
+    if (pendingBlock.size() >= WAVE_WRITER_BLOCK_SIZE) {
+        submitPendingBlock();
+    }
+}
+
+void PSGWaveFileWriter::submitPendingBlock() {
+
+    if (pendingBlock.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    // Don't let the queue grow without limit if the disk can't keep up
+    queueChanged.wait(lock, [this] { return queuedBlocks.size() < WAVE_WRITER_MAX_QUEUED_BLOCKS; });
+
+    queuedBlocks.push_back(std::move(pendingBlock));
+    lock.unlock();
+    queueChanged.notify_all();
+
+    pendingBlock = std::vector<char>();
+    pendingBlock.reserve(WAVE_WRITER_BLOCK_SIZE);
+}
+
+void PSGWaveFileWriter::runWriterThread() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    while (true) {
+        queueChanged.wait(lock, [this] { return !queuedBlocks.empty() || isClosing; });
+
+        if (queuedBlocks.empty()) {
+            // Closing and everything has been written
+            return;
+        }
+
+        std::vector<char> block = std::move(queuedBlocks.front());
+        queuedBlocks.pop_front();
+
+        lock.unlock();
+        queueChanged.notify_all();
+
+        if (!file.write(block.data(), block.size())) {
+            hasWriteFailed = true;
+        }
+
+        lock.lock();
+    }
+}
+
+void PSGWaveFileWriter::close() {
+
+    if (isClosed) {
+        return;
+    }
+
+    isClosed = true;
+
+    submitPendingBlock();
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        isClosing = true;
+    }
+
+    queueChanged.notify_all();
+    writerThread.join();
+
+    if (!isRaw) {
+        // Fill in the sizes in the header now that the amount of data is known (sizes are capped at what the format can hold)
+        auto dataChunkSize = (unsigned int)std::min<unsigned long long>(dataSize, 0xFFFFFFFFULL - (WAVE_HEADER_SIZE - 8));
+
+        std::vector<char> size;
+        appendLittleEndian(size, dataChunkSize + (WAVE_HEADER_SIZE - 8), 4);
+        appendLittleEndian(size, dataChunkSize, 4);
+
+        file.seekp(4);
+        file.write(size.data(), 4);
+        file.seekp(WAVE_HEADER_SIZE - 4);
+        file.write(size.data() + 4, 4);
+    }
+
+    file.close();
+
+    if (!file || hasWriteFailed) {
+        Log::error("Failed to write to audio output file '" + fileName + "'");
+    }
+}
+
+bool PSGWaveFileWriter::isRealTime() {
+    return false;
+}
+
+void PSGWaveFileWriter::printDebugInfo() {
+    std::cout << "Audio written to '" << fileName << "': " << (dataSize / 2) << " samples" << std::endl;
+}
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <iterator>
+#include "ROMDatabase.h"
+
+namespace {
+
+    // Must be kept sorted by CRC, which is checked when compiling
+    constexpr ROMDatabaseEntry entries[] = {
+        {0x0047B615, "Predator 2", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x06965ED9, "F-1 Spirit", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x0A77FA5E, "Nemesis 2", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x0CA95637, "Laser Ghost", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x1575581D, "Shadow of the Beast", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x18FB98A3, "Jang Pung 3", MapperKorean, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x205CAAE8, "Operation Wolf", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x29822980, "Cosmic Spacehead", MapperCodemasters, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x2D48C1D3, "Back to the Future Part III", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x445525E2, "Penguin Adventure", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x5B3B922C, "Sonic the Hedgehog 2", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x67C2F0FF, "Super Boy 2", MapperKorean, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x72420F38, "Addams Family", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x77EFE84A, "Cyborg Z", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x83F0EEDE, "Street Master", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x85CFC9C9, "Taito Chase H.Q.", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x861B6E79, "Assault City (Light Phaser)", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x8813514B, "Excellent Dizzy Collection (Prototype)", MapperCodemasters, CartridgeRegion::Europe, VideoStandardPAL},
+        {0x89B79E77, "Dodgeball King", MapperKorean, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x9195C34C, "Super Boy 3", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x97D03541, "Sangokushi 3", MapperKorean, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0x9F951756, "RoboCop 3", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xA05258F5, "Won-Si-In", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0xA577CE46, "Micro Machines", MapperCodemasters, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xB9664AE1, "Fantastic Dizzy", MapperCodemasters, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xC0E25D62, "California Games II", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xC9DBF936, "Home Alone", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xCA1D3752, "Space Harrier (Europe)", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xD6F2BFCA, "Sonic the Hedgehog 2 (Rev 1)", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xE316C06D, "Nemesis", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC},
+        {0xE8215C2E, "Marksman Shooting & Trap Shooting & Safari Hunt", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xEA5C3A6F, "Dinobasher Starring Bignose the Caveman (Prototype)", MapperCodemasters, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xF8176918, "Sensible Soccer", MapperSega, CartridgeRegion::Europe, VideoStandardPAL},
+        {0xF89AF3CC, "Knightmare II", MapperKoreanMSX, CartridgeRegion::Korea, VideoStandardNTSC}
+    };
+
+    constexpr bool isSorted() {
+        for (size_t i = 1; i < sizeof(entries) / sizeof(entries[0]); i++) {
+            if (entries[i - 1].crc >= entries[i].crc) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static_assert(isSorted(), "ROM database entries must be sorted by CRC, with no duplicates");
+}
+
+const ROMDatabaseEntry *ROMDatabase::find(uint32_t crc) {
+    auto end = std::end(entries);
+    auto entry = std::lower_bound(std::begin(entries), end, crc, [](const ROMDatabaseEntry &entry, uint32_t crc) {
+        return entry.crc < crc;
+    });
+
+    if (entry == end || entry->crc != crc) {
+        return nullptr;
+    }
+
+    return entry;
+}
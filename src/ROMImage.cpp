@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <fstream>
+#include "ROMImage.h"
+#include "Utils.h"
+#include "Log.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+std::mutex ROMImage::registryMutex;
+
+std::map<std::string, std::weak_ptr<const ROMImage>> ROMImage::registry;
+
+std::shared_ptr<const ROMImage> ROMImage::load(const std::string &fileName) {
+#ifdef VERBOSE_MODE
+    Log::message("Loading ROM: " + fileName);
+#endif
+
+    // Held while loading, so that machines starting at the same time don't all load their own copy
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // Forget images which every machine has finished with, so that the registry doesn't keep growing
+    for (auto entry = registry.begin(); entry != registry.end();) {
+        entry = entry->second.expired() ? registry.erase(entry) : std::next(entry);
+    }
+
+    std::shared_ptr<ROMImage> image(new ROMImage());
+
+    if (!image->loadFile(fileName)) {
+        return nullptr;
+    }
+
+    auto existing = registry.find(fileName);
+
+    if (existing != registry.end()) {
+        std::shared_ptr<const ROMImage> existingImage = existing->second.lock();
+
+        // The file hasn't changed, so the new image is dropped in favour of the one already being used
+        if (existingImage && existingImage->isSameFile(*image)) {
+            return existingImage;
+        }
+    }
+
+    image->parseHeader();
+    image->applyDatabaseEntry();
+
+    registry[fileName] = image;
+
+    return image;
+}
+
+ROMImage::ROMImage() {
+    fileData = nullptr;
+    fileDataSize = 0;
+    headerOffset = 0;
+    mappedFile = nullptr;
+    crc = 0;
+    mapper = CartridgeMapper::MapperSega;
+    bankMask = 0x0;
+    region = CartridgeRegion::Unknown;
+    videoStandard = VideoStandard::VideoStandardNTSC;
+    fileSize = 0;
+    fileModifiedTime = 0;
+}
+
+ROMImage::~ROMImage() {
+#ifndef _WIN32
+    if (mappedFile != nullptr) {
+        munmap(mappedFile, fileDataSize);
+    }
+#endif
+}
+
+bool ROMImage::loadFile(const std::string &fileName) {
+#ifdef _WIN32
+    // Without memory mapping, the whole file is read in
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+
+    if (!file) {
+        Log::error("Error: ROM file does not exist");
+        return false;
+    }
+
+    auto size = (size_t)file.tellg();
+
+    if (size == 0 || size > MAX_CARTRIDGE_SIZE) {
+        Log::error("Error: ROM file is empty or too large");
+        return false;
+    }
+
+    fileSize = (int64_t)size;
+
+    // The copier header is skipped rather than copied, the ROM just starts further into the file
+    if ((size % ROM_BANK_SIZE) == COPIER_HEADER_SIZE) {
+        headerOffset = COPIER_HEADER_SIZE;
+    }
+
+    // Padded out to whole banks, as banks are always switched in whole
+    size_t bankCount = (size - headerOffset + ROM_BANK_SIZE - 1) / ROM_BANK_SIZE;
+    fileContents.resize(headerOffset + bankCount * ROM_BANK_SIZE);
+    file.seekg(0);
+
+    if (!file.read((char *)fileContents.data(), (std::streamsize)size)) {
+        Log::error("Error: Unable to read ROM file");
+        fileContents.clear();
+        return false;
+    }
+
+    fileData = fileContents.data();
+    fileDataSize = size;
+
+    return true;
+#else
+    int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+
+    if (fileDescriptor < 0) {
+        Log::error("Error: ROM file does not exist");
+        return false;
+    }
+
+    struct stat fileStat{};
+
+    // Do some standard checks on the file to decide on whether it is kosher or not (This is not 100%, but we at least should check obvious stuff)
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size <= 0 || fileStat.st_size > MAX_CARTRIDGE_SIZE) {
+        Log::error("Error: ROM file is empty or too large");
+        close(fileDescriptor);
+        return false;
+    }
+
+    fileSize = (int64_t)fileStat.st_size;
+    fileModifiedTime = fileStat.st_mtime;
+
+    auto size = (size_t)fileStat.st_size;
+
+    // The copier header is skipped rather than copied, the ROM just starts further into the file
+    if ((size % ROM_BANK_SIZE) == COPIER_HEADER_SIZE) {
+        headerOffset = COPIER_HEADER_SIZE;
+    }
+
+    // Banks are always switched in whole, so a ROM which doesn't fill its last bank is read into a padded copy instead
+    bool isWholeBanks = ((size - headerOffset) % ROM_BANK_SIZE) == 0;
+    bool loaded = (isWholeBanks && mapFile(fileDescriptor, size)) || readFile(fileDescriptor, size);
+
+    // A mapping stays valid once the file is closed
+    close(fileDescriptor);
+
+    if (!loaded) {
+        Log::error("Error: Unable to read ROM file");
+    }
+
+    return loaded;
+#endif
+}
+
+bool ROMImage::isSameFile(const ROMImage &other) const {
+#ifdef _WIN32
+    // The modification time isn't available here, so the contents are compared instead
+    return fileDataSize == other.fileDataSize && std::equal(fileData, fileData + fileDataSize, other.fileData);
+#else
+    return fileSize == other.fileSize && fileModifiedTime == other.fileModifiedTime;
+#endif
+}
+
+#ifndef _WIN32
+bool ROMImage::mapFile(int fileDescriptor, size_t size) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    mappedFile = mapping;
+    fileData = (const unsigned char *)mapping;
+    fileDataSize = size;
+
+    return true;
+}
+
+bool ROMImage::readFile(int fileDescriptor, size_t size) {
+    size_t bankCount = (size - headerOffset + ROM_BANK_SIZE - 1) / ROM_BANK_SIZE;
+    fileContents.resize(headerOffset + bankCount * ROM_BANK_SIZE);
+    size_t position = 0;
+
+    while (position < size) {
+        auto bytesRead = read(fileDescriptor, &fileContents[position], (unsigned int)(size - position));
+
+        if (bytesRead <= 0) {
+            fileContents.clear();
+            return false;
+        }
+
+        position += (size_t)bytesRead;
+    }
+
+    fileData = fileContents.data();
+    fileDataSize = size;
+
+    return true;
+}
+#endif
+
+bool ROMImage::hasBytesAt(size_t location, size_t length) const {
+    return location + length <= getSize();
+}
+
+void ROMImage::parseHeader() {
+    const unsigned char *rom = getData();
+
+    // Locate the ROM header (3 possible locations, might not be 100% needed as it is said to be always located at 7FF0, but check anyway just in case one of some of the cartridges wanted to be special)
+    unsigned short romHeaderPossibleLocations[3] = {0x1FF0, 0x3FF0, 0x7FF0};
+
+    unsigned char validRomText[8] = {0x54, 0x4D, 0x52, 0x20, 0x53, 0x45, 0x47, 0x41}; // TMR SEGA in hex
+
+    bool headerFound = false;
+
+    // Note: This 'header' isn't an actual file header, it is a piece of information included in the game ROMs for the USA/EU SMS/GG BIOS to verify the validity of the game.
+    for (unsigned short location : romHeaderPossibleLocations) {
+
+        // Search for the usual ASCII text which should be present in all ROM headers to determine where it is.
+        if (hasBytesAt(location, 8) && std::equal(validRomText, validRomText + 8, rom + location)) {
+            // Valid ROM header found
+            headerFound = true;
+
+#ifdef VERBOSE_MODE
+            Log::message("ROM Header found at: 0x" + Utils::formatHexNumber(location));
+#endif
+
+            break;
+        }
+    }
+
+    /* Determine whether the cartridge is a Codemasters cartridge or not
+    Codemasters ROMs include an extra header at 0x7FE0-0x7FE8 including some information, we only care about the checksum.
+
+    Had trouble working out this bit myself, this bit is based on a solution from the following source:
+    http://www.codeslinger.co.uk/pages/projects/mastersystem/starting.html
+
+    This check is required as these games use their own separate memory mapper which does not work like the standard one.
+    */
+
+    mapper = CartridgeMapper::MapperSega;
+
+    if (hasBytesAt(0x7FE6, 4)) {
+        unsigned short checksum = rom[0x7FE7] << 8;
+        checksum |= rom[0x7FE6];
+
+        if (checksum != 0x0) {
+            unsigned short checksumTest = 0x10000 - checksum;
+
+            unsigned short answer = rom[0x7FE9] << 8;
+
+            answer |= rom[0x7FE8];
+
+            if (checksumTest == answer) {
+                mapper = CartridgeMapper::MapperCodemasters;
+            }
+        }
+    }
+
+    // Determine region of the cartridge (TODO: Make this work better in future, relying on the TMR SEGA text being present is not really a reliable way)
+    if (headerFound) {
+        region = CartridgeRegion::USA; // Assume USA for now, TODO: add some detection for PAL regions
+    } else {
+        region = CartridgeRegion::Japan;
+    }
+
+    // Determine cartridge size, as mapping needs to work slightly differently depending on that.
+    determineCartridgeSize(getSize());
+}
+
+void ROMImage::applyDatabaseEntry() {
+    crc = Utils::crc32(getData(), getSize());
+
+    const ROMDatabaseEntry *entry = ROMDatabase::find(crc);
+
+    if (entry == nullptr) {
+        return;
+    }
+
+    name = entry->name;
+    mapper = entry->mapper;
+    region = entry->region;
+    videoStandard = entry->videoStandard;
+
+#ifdef VERBOSE_MODE
+    Log::message("ROM found in database: " + name);
+#endif
+}
+
+void ROMImage::determineCartridgeSize(size_t ROMSize) {
+
+    if (ROMSize > (0x3F * 0x4000)) {
+        bankMask = 0xFF;
+        return;
+    }
+
+    if (ROMSize > (0x1F * 0x4000)) {
+        bankMask = 0x3F;
+        return;
+    }
+
+    bankMask = 0x1F;
+}
+
+const unsigned char *ROMImage::getData() const {
+    return fileData + headerOffset;
+}
+
+size_t ROMImage::getSize() const {
+    return fileDataSize - headerOffset;
+}
+
+size_t ROMImage::getBankCount() const {
+    return (getSize() + ROM_BANK_SIZE - 1) / ROM_BANK_SIZE;
+}
+
+uint32_t ROMImage::getCRC32() const {
+    return crc;
+}
+
+const std::string &ROMImage::getName() const {
+    return name;
+}
+
+CartridgeMapper ROMImage::getMapper() const {
+    return mapper;
+}
+
+bool ROMImage::isCodemasters() const {
+    return mapper == CartridgeMapper::MapperCodemasters;
+}
+
+unsigned char ROMImage::getBankMask() const {
+    return bankMask;
+}
+
+CartridgeRegion ROMImage::getRegion() const {
+    return region;
+}
+
+VideoStandard ROMImage::getVideoStandard() const {
+    return videoStandard;
+}
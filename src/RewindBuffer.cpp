@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "RewindBuffer.h"
+
+RewindBuffer::RewindBuffer(size_t stateSize, size_t memoryLimit, size_t maxStates) {
+    this->stateSize = stateSize;
+
+    newestState.resize(stateSize);
+    writeBuffer.resize(stateSize);
+
+    // Runs are separated by at least REWIND_MIN_UNCHANGED_RUN unchanged bytes, and each run's two lengths take at most ten bytes each
+    encodeBuffer.resize(stateSize + ((stateSize / REWIND_MIN_UNCHANGED_RUN) + 1) * 20);
+
+    deltaMemory.resize(memoryLimit);
+    deltas.resize(std::max(maxStates, (size_t)1));
+
+    pushCount = 0;
+    droppedCount = 0;
+    averageDeltaLength = 0;
+    averagePushTime = 0;
+
+    clear();
+}
+
+uint8_t *RewindBuffer::getWriteBuffer() {
+    return writeBuffer.data();
+}
+
+void RewindBuffer::push() {
+    auto start = std::chrono::steady_clock::now();
+
+    if (hasNewestState) {
+        size_t length = encodeDelta(writeBuffer.data(), newestState.data(), encodeBuffer.data());
+
+        if (length > deltaMemory.size()) {
+            // Too big to ever fit, so the history has to start again from this state
+            clear();
+        } else {
+            if (deltaCount == deltas.size()) {
+                dropOldest();
+            }
+
+            size_t offset = allocate(length);
+            std::memcpy(&deltaMemory[offset], encodeBuffer.data(), length);
+
+            deltas[(firstDelta + deltaCount) % deltas.size()] = {offset, length};
+            deltaCount++;
+
+            averageDeltaLength += ((double)length - averageDeltaLength) * 0.05;
+        }
+    }
+
+    // The write buffer becomes the newest state, and the old newest state is written over next time
+    newestState.swap(writeBuffer);
+    hasNewestState = true;
+    pushCount++;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    averagePushTime += (elapsed.count() - averagePushTime) * 0.05;
+}
+
+const uint8_t *RewindBuffer::stepBack() {
+    if (deltaCount == 0) {
+        return nullptr;
+    }
+
+    const Delta &delta = deltas[(firstDelta + deltaCount - 1) % deltas.size()];
+    applyDelta(&deltaMemory[delta.offset], delta.length, newestState.data());
+    deltaCount--;
+
+    return newestState.data();
+}
+
+size_t RewindBuffer::getAvailableSteps() {
+    return deltaCount;
+}
+
+void RewindBuffer::clear() {
+    hasNewestState = false;
+    firstDelta = 0;
+    deltaCount = 0;
+}
+
+void RewindBuffer::printDebugInfo() {
+    std::cout << "Rewind states: " << deltaCount << " (" << droppedCount << " dropped)" << std::endl;
+    std::cout << "Rewind average delta size: " << averageDeltaLength << " bytes (state is " << stateSize << " bytes)" << std::endl;
+    std::cout << "Rewind average time per state: " << averagePushTime * 1e6 << "us" << std::endl;
+}
+
+size_t RewindBuffer::encodeDelta(const uint8_t *newer, const uint8_t *older, uint8_t *output) {
+    uint8_t *start = output;
+    size_t position = 0;
+
+    while (position < stateSize) {
+        size_t runStart = position;
+
+        // Skip over unchanged bytes, eight at a time where possible
+        while (position + 8 <= stateSize) {
+            uint64_t newerWord;
+            uint64_t olderWord;
+            std::memcpy(&newerWord, newer + position, 8);
+            std::memcpy(&olderWord, older + position, 8);
+
+            if (newerWord != olderWord) {
+                break;
+            }
+
+            position += 8;
+        }
+
+        while (position < stateSize && newer[position] == older[position]) {
+            position++;
+        }
+
+        size_t unchangedLength = position - runStart;
+        size_t changedStart = position;
+        size_t changedEnd = position;
+
+        // The changed run carries on until a long enough unchanged run (or the end) is found
+        while (position < stateSize) {
+            if (newer[position] != older[position]) {
+                changedEnd = ++position;
+                continue;
+            }
+
+            size_t unchangedEnd = position;
+
+            while (unchangedEnd < stateSize && unchangedEnd - position < REWIND_MIN_UNCHANGED_RUN && newer[unchangedEnd] == older[unchangedEnd]) {
+                unchangedEnd++;
+            }
+
+            if (unchangedEnd - position >= REWIND_MIN_UNCHANGED_RUN || unchangedEnd == stateSize) {
+                break;
+            }
+
+            position = unchangedEnd;
+        }
+
+        position = changedEnd;
+
+        output = writeLength(output, unchangedLength);
+        output = writeLength(output, changedEnd - changedStart);
+
+        for (size_t i = changedStart; i < changedEnd; i++) {
+            *output++ = newer[i] ^ older[i];
+        }
+    }
+
+    // Even if nothing has changed this is at least two bytes, so that deltas can always be told apart in the ring
+    return output - start;
+}
+
+void RewindBuffer::applyDelta(const uint8_t *delta, size_t length, uint8_t *state) {
+    const uint8_t *end = delta + length;
+    size_t position = 0;
+
+    while (delta < end) {
+        size_t unchangedLength;
+        size_t changedLength;
+
+        delta = readLength(delta, unchangedLength);
+        delta = readLength(delta, changedLength);
+
+        position += unchangedLength;
+
+        for (size_t i = 0; i < changedLength; i++) {
+            state[position++] ^= *delta++;
+        }
+    }
+}
+
+size_t RewindBuffer::allocate(size_t length) {
+    while (deltaCount > 0) {
+        const Delta &oldest = deltas[firstDelta];
+        const Delta &newest = deltas[(firstDelta + deltaCount - 1) % deltas.size()];
+        size_t newestEnd = newest.offset + newest.length;
+
+        if (newestEnd > oldest.offset) {
+            // Not wrapped around yet - there is space after the newest delta, and before the oldest one
+            if (deltaMemory.size() - newestEnd >= length) {
+                return newestEnd;
+            }
+
+            if (oldest.offset >= length) {
+                return 0;
+            }
+        } else if (oldest.offset - newestEnd >= length) {
+            // Wrapped around - the only space is between the newest and the oldest delta
+            return newestEnd;
+        }
+
+        dropOldest();
+    }
+
+    return 0;
+}
+
+void RewindBuffer::dropOldest() {
+    firstDelta = (firstDelta + 1) % deltas.size();
+    deltaCount--;
+    droppedCount++;
+}
+
+uint8_t *RewindBuffer::writeLength(uint8_t *output, size_t value) {
+    // Seven bits at a time, with the top bit set on every byte but the last
+    while (value >= 0x80) {
+        *output++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+
+    *output++ = (uint8_t)value;
+
+    return output;
+}
+
+const uint8_t *RewindBuffer::readLength(const uint8_t *input, size_t &value) {
+    value = 0;
+    unsigned int shift = 0;
+
+    while (*input & 0x80) {
+        value |= (size_t)(*input++ & 0x7F) << shift;
+        shift += 7;
+    }
+
+    value |= (size_t)(*input++) << shift;
+
+    return input;
+}
@@ -0,0 +1,51 @@
+#include <chrono>
+#include <iostream>
+#include "RunAhead.h"
+#include "Exceptions.h"
+
+RunAhead::RunAhead(Console *console, unsigned int frames) {
+    if (frames < 1 || frames > RUN_AHEAD_MAX_FRAMES) {
+        throw ConfigurationException("Run-ahead must be between 1 and " + std::to_string(RUN_AHEAD_MAX_FRAMES) + " frames");
+    }
+
+    this->console = console;
+    this->frames = frames;
+    state.resize(console->getSaveStateSize());
+    totalCost = 0;
+    frameCount = 0;
+}
+
+/**
+ * Whether a frame is drawn is decided when the one before it finishes, so rendering is turned on during the frame
+ * before the last one run ahead, and off again during the last one so that the next real frame isn't drawn.
+ */
+void RunAhead::emulateFrame(bool hasFocus) {
+    console->setVideoRenderingEnabled(frames == 1);
+    console->emulateFrame(hasFocus);
+
+    auto start = std::chrono::steady_clock::now();
+
+    console->saveState(state.data(), state.size());
+    console->setSpeculative(true);
+
+    for (unsigned int frame = 1; frame <= frames; frame++) {
+        console->setVideoRenderingEnabled(frame == frames - 1);
+        console->emulateFrame(hasFocus);
+    }
+
+    // The video output isn't part of the state, so it still holds the last frame run ahead
+    console->setSpeculative(false);
+    console->restoreState(state.data(), state.size());
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    totalCost += elapsed.count();
+    frameCount++;
+}
+
+double RunAhead::getAverageCost() {
+    return frameCount > 0 ? totalCost / frameCount : 0;
+}
+
+void RunAhead::printDebugInfo() {
+    std::cout << "Run-ahead: " << frames << " frame(s), " << getAverageCost() * 1e6 << "us per frame" << std::endl;
+}
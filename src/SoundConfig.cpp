@@ -1,8 +1,13 @@
 #include "SoundConfig.h"
+#include "Exceptions.h"
+#include "Utils.h"
 
 SoundConfig::SoundConfig() {
     enabled = true;
     volume = 50;
+    sampleRate = SOUND_DEFAULT_SAMPLE_RATE;
+    outputType = SoundOutputType::Playback;
+    outputFileName = "output.wav";
 }
 
 #ifdef JSON_CONFIG_FILE
@@ -10,6 +15,24 @@ json SoundConfig::getSoundConfigurationJson() {
     json output;
     output["enabled"] = enabled;
     output["volume"] = volume;
+    output["sampleRate"] = sampleRate;
+
+    switch (outputType) {
+        case SoundOutputType::Playback:
+            output["output"] = "playback";
+            break;
+        case SoundOutputType::WaveFile:
+            output["output"] = "wav";
+            break;
+        case SoundOutputType::RawFile:
+            output["output"] = "raw";
+            break;
+        case SoundOutputType::NoOutput:
+            output["output"] = "none";
+            break;
+    }
+
+    output["outputFile"] = outputFileName;
     return output;
 }
 
@@ -30,7 +53,36 @@ void SoundConfig::setFromConfig(json soundConfigurationJson) {
             volume = 100;
         }
     }
-    // TODO allow for other options such as output buffer size etc.
+
+    if (JsonHandler::keyExists(soundConfigurationJson, "sampleRate")) {
+        int rate = JsonHandler::getInteger(soundConfigurationJson, "sampleRate");
+
+        if (rate < SOUND_MIN_SAMPLE_RATE || rate > SOUND_MAX_SAMPLE_RATE) {
+            throw ConfigurationException(Utils::implodeString({"Sound sample rate must be between ", std::to_string(SOUND_MIN_SAMPLE_RATE), " and ", std::to_string(SOUND_MAX_SAMPLE_RATE)}));
+        }
+
+        sampleRate = (unsigned int)rate;
+    }
+
+    if (JsonHandler::keyExists(soundConfigurationJson, "output")) {
+        std::string output = JsonHandler::getString(soundConfigurationJson, "output");
+
+        if (output == "playback") {
+            outputType = SoundOutputType::Playback;
+        } else if (output == "wav") {
+            outputType = SoundOutputType::WaveFile;
+        } else if (output == "raw") {
+            outputType = SoundOutputType::RawFile;
+        } else if (output == "none") {
+            outputType = SoundOutputType::NoOutput;
+        } else {
+            throw ConfigurationException(Utils::implodeString({"Unknown sound output '", output, "', must be one of 'playback', 'wav', 'raw' or 'none'"}));
+        }
+    }
+
+    if (JsonHandler::keyExists(soundConfigurationJson, "outputFile")) {
+        outputFileName = JsonHandler::getString(soundConfigurationJson, "outputFile");
+    }
 }
 
 #endif
@@ -41,4 +93,16 @@ bool SoundConfig::isEnabled() {
 
 int SoundConfig::getVolume() {
     return volume;
-}
\ No newline at end of file
+}
+
+unsigned int SoundConfig::getSampleRate() {
+    return sampleRate;
+}
+
+SoundOutputType SoundConfig::getOutputType() {
+    return outputType;
+}
+
+std::string SoundConfig::getOutputFileName() {
+    return outputFileName;
+}
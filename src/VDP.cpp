@@ -2,6 +2,8 @@
 #include "Utils.h"
 #include "Exceptions.h"
 #include "iostream"
+#include <algorithm>
+#include <cstring>
 
 VDP::VDP() {
     for (auto &vRAMByte : vRAM) {
@@ -46,13 +48,21 @@ VDP::VDP() {
     vRefresh = false;
     isVBlanking = false;
     vCounterJumpCount = 0;
-    displayMode = VDPDisplayMode::getDisplayMode(SMSDisplayMode::NTSCSmall); // TODO should this be the default? just using it for now.
-    workingBuffer = new sf::Uint8[256 * 224 * 4];
-    outputBuffer = new sf::Uint8[256 * 224 * 4];
+    videoStandard = VideoStandard::VideoStandardNTSC;
+    displayMode = VDPDisplayMode::getDisplayMode(SMSDisplayMode::NTSCSmall);
+    workingBuffer = new uint8_t[256 * 224 * 4];
+    outputBuffer = new uint8_t[256 * 224 * 4];
     vScroll = 0;
     lineInterruptCounter = 0;
     clearScreen();
-    fillVideoOutput();
+    std::memset(outputBuffer, 0, 256 * 224 * 4);
+    hasDirtyLines = true;
+    dirtyLineStart = 0;
+    dirtyLineEnd = 223;
+
+    frameCount = 0;
+    isRenderingEnabled = true;
+    isRenderingFrame = true;
 }
 
 VDP::~VDP() {
@@ -76,6 +86,55 @@ void VDP::execute(float cycles) {
     }
 }
 
+void VDP::saveState(StateWriter &writer) {
+    writer.beginSection(SaveStateSection::SaveStateVDP);
+
+    writer.writeBlock(vRAM, sizeof(vRAM));
+    writer.writeBlock(cRAM, sizeof(cRAM));
+    writer.writeBlock(registers, sizeof(registers));
+
+    writer.writeByte(statusRegister);
+    writer.writeWord(controlWord);
+    writer.writeByte(readBuffer);
+    writer.writeBool(requestInterrupt);
+    writer.writeBool(isSecondControlWrite);
+    writer.writeWord(hCounter);
+    writer.writeByte(vCounter);
+    writer.writeBool(vRefresh);
+    writer.writeBool(isVBlanking);
+    writer.writeByte(vScroll);
+    writer.writeByte(lineInterruptCounter);
+    writer.writeByte(vCounterJumpCount);
+    writer.writeByte(displayMode.getActiveDisplayEnd());
+    writer.writeQuad(frameCount);
+}
+
+void VDP::loadState(StateReader &reader) {
+    reader.beginSection(SaveStateSection::SaveStateVDP);
+
+    reader.readBlock(vRAM, sizeof(vRAM));
+    reader.readBlock(cRAM, sizeof(cRAM));
+    reader.readBlock(registers, sizeof(registers));
+
+    statusRegister = reader.readByte();
+    controlWord = reader.readWord();
+    readBuffer = reader.readByte();
+    requestInterrupt = reader.readBool();
+    isSecondControlWrite = reader.readBool();
+    hCounter = reader.readWord() % 685;
+    vCounter = reader.readByte();
+    vRefresh = reader.readBool();
+    isVBlanking = reader.readBool();
+    vScroll = reader.readByte();
+    lineInterruptCounter = reader.readByte();
+    vCounterJumpCount = reader.readByte();
+
+    // The video standard comes from the cartridge rather than the state, so the modes are told apart by their height
+    setDisplayMode(reader.readByte());
+
+    frameCount = (unsigned long)reader.readQuad();
+}
+
 void VDP::handleScanlineChange() {
 
     // End of the current scanline
@@ -83,16 +142,20 @@ void VDP::handleScanlineChange() {
     unsigned char currentVCounter = vCounter;
     ++vCounter;
 
-    // Handle VCounter timing/increment events
-    if (currentVCounter == 255) {
+    // Handle VCounter timing/increment events. PAL's medium mode jumps from 255 back to 0 once before the frame ends.
+    if (!handleVCounterJump(currentVCounter) && currentVCounter == 255) {
         // End of vertical refresh - start rendering the next frame
         vCounter = 0;
         vCounterJumpCount = 0; // Ensure that we don't end up moving the VCounter back every time, should be done once per frame
         renderScanline();
-        fillVideoOutput(); // Fill the video output workingBuffer with the current full frame
+
+        if (isRenderingFrame) {
+            fillVideoOutput(); // Fill the video output workingBuffer with the current full frame
+        }
+
         clearScreen();
-    } else {
-        handleVCounterJump(currentVCounter);
+        isRenderingFrame = isRenderingEnabled;
+        ++frameCount;
     }
 
     if (vCounterJumpCount == 0 && vCounter == displayMode.getActiveDisplayEnd()) {
@@ -101,7 +164,11 @@ void VDP::handleScanlineChange() {
         Utils::setBit(7, true, statusRegister);
     }
 
-    if (vCounter <= displayMode.getActiveDisplayEnd()) {
+    // Once the VCounter has jumped back it can pass over the active display's values again, e.g. PAL counts 0xBA
+    // to 0xFF after 0xF2, but those lines are all part of vertical refresh
+    bool isActiveDisplayPass = vCounterJumpCount == 0;
+
+    if (isActiveDisplayPass && vCounter <= displayMode.getActiveDisplayEnd()) {
 
         if (vCounter != displayMode.getActiveDisplayEnd()) {
             // Active display - render this scanline
@@ -118,7 +185,7 @@ void VDP::handleScanlineChange() {
         }
     }
 
-    if (vCounter >= displayMode.getActiveDisplayEnd()) {
+    if (!isActiveDisplayPass || vCounter >= displayMode.getActiveDisplayEnd()) {
         // Inactive display area
         if (vCounter != displayMode.getActiveDisplayEnd()) {
             // Line interrupt counter should be loaded on the first scanline after the active display period
@@ -128,16 +195,15 @@ void VDP::handleScanlineChange() {
         vScroll = registers[0x9];
 
         // Allow the screen resolution to change
-        // TODO handle PAL modes
         switch (getMode()) {
             case 11:
-                displayMode = VDPDisplayMode::getDisplayMode(SMSDisplayMode::NTSCMedium);
+                setDisplayMode(224);
                 break;
             case 14:
-                displayMode = VDPDisplayMode::getDisplayMode(SMSDisplayMode::NTSCLarge);
+                setDisplayMode(240);
                 break;
             default:
-                displayMode = VDPDisplayMode::getDisplayMode(SMSDisplayMode::NTSCSmall);
+                setDisplayMode(192);
                 break;
         }
     }
@@ -297,14 +363,49 @@ bool VDP::isRequestingInterrupt() {
 void VDP::renderScanline() {
     if (getMode() == 2) {
         renderSpritesMode2();
-        renderBackgroundMode2();
+
+        if (isRenderingFrame) {
+            renderBackgroundMode2();
+        }
     } else {
         renderSpritesMode4();
-        renderBackgroundMode4();
+
+        if (isRenderingFrame) {
+            renderBackgroundMode4();
+        }
+    }
+}
+
+unsigned long VDP::getFrameCount() {
+    return frameCount;
+}
+
+void VDP::setRenderingEnabled(bool enabled) {
+    isRenderingEnabled = enabled;
+}
+
+void VDP::setVideoStandard(VideoStandard standard) {
+    videoStandard = standard;
+    setDisplayMode(displayMode.getActiveDisplayEnd());
+}
+
+void VDP::setDisplayMode(unsigned char activeDisplayEnd) {
+    bool isPAL = videoStandard == VideoStandard::VideoStandardPAL;
+
+    switch (activeDisplayEnd) {
+        case 224:
+            displayMode = VDPDisplayMode::getDisplayMode(isPAL ? SMSDisplayMode::PALMedium : SMSDisplayMode::NTSCMedium);
+            break;
+        case 240:
+            displayMode = VDPDisplayMode::getDisplayMode(isPAL ? SMSDisplayMode::PALLarge : SMSDisplayMode::NTSCLarge);
+            break;
+        default:
+            displayMode = VDPDisplayMode::getDisplayMode(isPAL ? SMSDisplayMode::PALSmall : SMSDisplayMode::NTSCSmall);
+            break;
     }
 }
 
-sf::Uint8* VDP::getVideoOutput() {
+uint8_t* VDP::getVideoOutput() {
     return outputBuffer;
 }
 
@@ -751,7 +852,7 @@ unsigned char VDP::getColourValue(unsigned char rgb) {
 
 //region Display output
 void VDP::clearScreen() {
-    for (int i = 0; i <= ((256 * 224) * 4); i += 4) {
+    for (int i = 0; i < ((256 * 224) * 4); i += 4) {
         workingBuffer[i] = 0; // R
         workingBuffer[i + 1] = 0; // G
         workingBuffer[i + 2] = 0; // B
@@ -760,12 +861,39 @@ void VDP::clearScreen() {
 }
 
 void VDP::fillVideoOutput() {
-    for (int i = 0; i <= ((256 * 224) * 4); i += 4) {
-        outputBuffer[i] = workingBuffer[i]; // R
-        outputBuffer[i + 1] = workingBuffer[i + 1]; // G
-        outputBuffer[i + 2] = workingBuffer[i + 2]; // B
-        outputBuffer[i + 3] = workingBuffer[i + 3]; // A
+    // Only copy the lines which differ from the previous frame, keeping a record of which ones changed so that the frontend can skip uploading the rest
+    const unsigned int lineSize = 256 * 4;
+
+    for (unsigned short line = 0; line < 224; line++) {
+        unsigned long offset = line * lineSize;
+
+        if (std::memcmp(outputBuffer + offset, workingBuffer + offset, lineSize) == 0) {
+            continue;
+        }
+
+        std::memcpy(outputBuffer + offset, workingBuffer + offset, lineSize);
+
+        if (!hasDirtyLines) {
+            dirtyLineStart = dirtyLineEnd = line;
+            hasDirtyLines = true;
+            continue;
+        }
+
+        dirtyLineStart = std::min(dirtyLineStart, line);
+        dirtyLineEnd = std::max(dirtyLineEnd, line);
+    }
+}
+
+bool VDP::consumeDirtyLines(unsigned short &firstLine, unsigned short &lastLine) {
+    if (!hasDirtyLines) {
+        return false;
     }
+
+    firstLine = dirtyLineStart;
+    lastLine = dirtyLineEnd;
+    hasDirtyLines = false;
+
+    return true;
 }
 
 void VDP::putPixel(unsigned long index, unsigned char r, unsigned char g, unsigned char b) {
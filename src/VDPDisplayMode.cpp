@@ -22,15 +22,12 @@ VDPDisplayMode VDPDisplayMode::getDisplayMode(SMSDisplayMode mode) {
                     VDPDisplayModeVCounterJump(0xF2, 0xBA)
             });
         case SMSDisplayMode::PALMedium:
-            return VDPDisplayMode(224, 225, false, {
+            return VDPDisplayMode(224, 255, true, {
                     VDPDisplayModeVCounterJump(0xFF, 0x0),
                     VDPDisplayModeVCounterJump(0x02, 0xCA)
             });
         case SMSDisplayMode::PALLarge:
-            return VDPDisplayMode(240, 255, false, {
-                    VDPDisplayModeVCounterJump(0xFF, 0x0),
-                    VDPDisplayModeVCounterJump(0x0A, 0xD2)
-            });
+            throw VDPException("PAL Large display mode is not supported");
         default:
             throw VDPException(Utils::implodeString({"Unhandled video mode"}));
     }
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include "VideoFrameExchange.h"
+
+void VideoFrame::markDirty(unsigned short firstLine, unsigned short lastLine) {
+
+    if (!hasDirtyLines) {
+        firstDirtyLine = firstLine;
+        lastDirtyLine = lastLine;
+        hasDirtyLines = true;
+        return;
+    }
+
+    firstDirtyLine = std::min(firstDirtyLine, firstLine);
+    lastDirtyLine = std::max(lastDirtyLine, lastLine);
+}
+
+VideoFrameExchange::VideoFrameExchange(size_t frameSize) {
+
+    for (auto &frame : frames) {
+        frame.pixels.resize(frameSize, 0);
+        frame.width = 0;
+        frame.height = 0;
+        frame.hasDirtyLines = false;
+        frame.firstDirtyLine = 0;
+        frame.lastDirtyLine = 0;
+    }
+
+    writeIndex = 0;
+    state = 1;
+    readIndex = 2;
+}
+
+VideoFrame *VideoFrameExchange::getWriteFrame() {
+    return &frames[writeIndex];
+}
+
+void VideoFrameExchange::publish() {
+    VideoFrame &frame = frames[writeIndex];
+
+    unsigned int currentState = state.load(std::memory_order_acquire);
+
+    while (true) {
+
+        if (currentState & FRAME_UNREAD) {
+            // The reader hasn't taken the frame which is about to be replaced, so this one has to cover its changes too.
+            // If the reader takes it before the swap below, the extra lines just get uploaded again.
+            const VideoFrame &unread = frames[currentState & FRAME_INDEX_MASK];
+
+            if (unread.hasDirtyLines) {
+                frame.markDirty(unread.firstDirtyLine, unread.lastDirtyLine);
+            }
+        }
+
+        if (state.compare_exchange_weak(currentState, writeIndex | FRAME_UNREAD, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            break;
+        }
+    }
+
+    writeIndex = currentState & FRAME_INDEX_MASK;
+    frames[writeIndex].hasDirtyLines = false;
+}
+
+VideoFrame *VideoFrameExchange::acquireLatest() {
+
+    if (!(state.load(std::memory_order_acquire) & FRAME_UNREAD)) {
+        return nullptr;
+    }
+
+    unsigned int previousState = state.exchange(readIndex, std::memory_order_acq_rel);
+    readIndex = previousState & FRAME_INDEX_MASK;
+
+    return &frames[readIndex];
+}
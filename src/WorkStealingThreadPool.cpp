@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <thread>
+#include "WorkStealingThreadPool.h"
+
+WorkStealingThreadPool::WorkStealingThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    this->threadCount = threadCount;
+    queues = std::vector<WorkerQueue>(threadCount);
+}
+
+unsigned int WorkStealingThreadPool::getThreadCount() {
+    return threadCount;
+}
+
+void WorkStealingThreadPool::run(size_t taskCount, const std::function<void(size_t)> &task) {
+    // Deal the tasks out like cards, so that neighbouring tasks (which are often similar sizes) end up on different threads
+    for (size_t i = 0; i < taskCount; i++) {
+        queues[i % threadCount].tasks.push_back(i);
+    }
+
+    std::vector<std::thread> threads;
+
+    // The calling thread is one of the workers
+    for (unsigned int worker = 1; worker < threadCount; worker++) {
+        threads.emplace_back(&WorkStealingThreadPool::runWorker, this, worker, std::cref(task));
+    }
+
+    runWorker(0, task);
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingThreadPool::runWorker(unsigned int worker, const std::function<void(size_t)> &task) {
+    size_t index;
+
+    // No new tasks are added while running, so once nothing can be found anywhere this worker is finished
+    while (popOwnTask(worker, index) || stealTask(worker, index)) {
+        task(index);
+    }
+}
+
+bool WorkStealingThreadPool::popOwnTask(unsigned int worker, size_t &task) {
+    WorkerQueue &queue = queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+
+    return true;
+}
+
+bool WorkStealingThreadPool::stealTask(unsigned int worker, size_t &task) {
+    for (unsigned int offset = 1; offset < threadCount; offset++) {
+        WorkerQueue &queue = queues[(worker + offset) % threadCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+
+            return true;
+        }
+    }
+
+    return false;
+}
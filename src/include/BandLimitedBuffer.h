@@ -0,0 +1,98 @@
+#ifndef MasterNostalgia_BANDLIMITEDBUFFER_H
+#define MasterNostalgia_BANDLIMITEDBUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+#define BLEP_KERNEL_WIDTH 16
+#define BLEP_KERNEL_PHASES 64
+#define BLEP_KERNEL_UNIT_BITS 14
+#define BLEP_HIGHPASS_SHIFT 9
+
+// Sample positions are 32.32 fixed point, so mapping clock times to samples never accumulates rounding error
+#define BLEP_POSITION_FRACTION_BITS 32
+
+/**
+ * Converts amplitude changes which happen at exact clock times into output samples at the output sample rate.
+ *
+ * Each change is recorded as a band-limited step (the difference between the old and new amplitude spread over a few
+ * samples using a windowed sinc kernel), and samples are produced by integrating the recorded changes. This means
+ * that the cost only depends on how many times the amplitude changes and how many samples are read out, and square
+ * waves don't alias like they would if they were just sampled at the output rate.
+ *
+ * This is a polyphase FIR resampler from the PSG's clock to the output rate: the kernel table holds one set of taps
+ * for each fractional sample position, and the cutoff is set relative to the output rate so it works for any rate.
+ * Kernel taps are 16-bit so that a whole phase can be applied with a few SIMD instructions (SSE2 or NEON).
+ */
+class BandLimitedBuffer {
+public:
+
+    /**
+     * @param sampleRate - Output sample rate
+     * @param clockRate - Number of clocks per second which times passed to addDelta/endFrame are measured in
+     * @param maxFrameSamples - The largest number of samples which can be waiting to be read at once
+     */
+    BandLimitedBuffer(unsigned int sampleRate, double clockRate, unsigned int maxFrameSamples);
+
+    /**
+     * Records a change in amplitude
+     * @param time - Clock time relative to the start of the current frame
+     * @param delta - Difference between the new and the old amplitude
+     */
+    void addDelta(unsigned int time, int delta);
+
+    /**
+     * Ends the current frame, making every sample before the given time available to be read. The next frame starts at this time.
+     * @param time - Clock time relative to the start of the current frame
+     */
+    void endFrame(unsigned int time);
+
+    /**
+     * Returns the number of clocks in a frame that will produce at most the given number of samples
+     */
+    unsigned int getClocksForSamples(unsigned int samples);
+
+    unsigned int getSamplesAvailable();
+
+    /**
+     * Scales the number of samples generated per clock, used to make small adjustments to the output rate.
+     * Should only be changed at the start of a frame.
+     */
+    void setRateAdjustment(double adjustment);
+
+    /**
+     * Reads and removes up to count samples from the buffer
+     * @return the number of samples read
+     */
+    unsigned int readSamples(int16_t *output, unsigned int count);
+
+    void clear();
+
+    /**
+     * Measures how long it takes to produce samples for a busy stream of changes (four channels at high pitches)
+     * @return the fraction of one CPU core needed to keep up with real time at the given sample rate
+     */
+    static double benchmark(unsigned int sampleRate, double clockRate);
+
+private:
+
+    // Samples per clock as 32.32 fixed point
+    uint64_t baseSamplesPerClock;
+
+    uint64_t samplesPerClock;
+
+    // Position of the start of the current frame in samples (32.32 fixed point), relative to the start of the buffer
+    uint64_t frameStartOffset;
+
+    unsigned int samplesAvailable;
+
+    int integrator;
+
+    std::vector<int> buffer;
+
+    alignas(16) short kernel[BLEP_KERNEL_PHASES][BLEP_KERNEL_WIDTH];
+
+    void generateKernel();
+};
+
+#endif //MasterNostalgia_BANDLIMITEDBUFFER_H
@@ -0,0 +1,68 @@
+#ifndef MasterNostalgia_BATCHRUNNER_H
+#define MasterNostalgia_BATCHRUNNER_H
+
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "JsonHandler.hpp"
+#include "WorkStealingThreadPool.h"
+
+#define BATCH_DEFAULT_FRAME_COUNT 600
+
+/**
+ * One ROM to run in a batch. If an input recording is given the ROM is played with it, and runs for the length of the
+ * recording unless a number of frames is given.
+ */
+struct BatchJob {
+    std::string romFileName;
+
+    // 0 for the length of the input recording (or BATCH_DEFAULT_FRAME_COUNT without one)
+    unsigned long frames;
+
+    std::string inputFileName;
+};
+
+/**
+ * Runs many ROMs at once, each in its own MasterSystem with no video, audio or input devices, and reports the results
+ * of each as a line of JSON as soon as it finishes:
+ *
+ * {"index":0,"rom":"game.sms","status":"ok","frames":600,"frameHash":"...","audioHash":"...","fps":2500.1,"seconds":0.24}
+ *
+ * status is "ok" if every frame was run, "stopped" if the CPU halted or hit an error first, or "error" if an exception
+ * was thrown (with the message in "error"). Hashes are of the final frame's video output and every audio sample.
+ */
+class BatchRunner {
+public:
+
+    /**
+     * @param threadCount - The number of ROMs to run at once, 0 meaning one per CPU core
+     */
+    explicit BatchRunner(unsigned int threadCount);
+
+    /**
+     * Reads a manifest, which is a JSON array of {"rom": "<file>", "frames": <count>, "input": "<recording file>"}
+     * objects - only "rom" is required
+     */
+    static std::vector<BatchJob> readManifest(const std::string &fileName);
+
+    /**
+     * Runs every job, writing each one's result to output as it finishes (so results aren't in manifest order)
+     * @return the number of jobs which didn't finish with the "ok" status
+     */
+    unsigned int run(const std::vector<BatchJob> &jobs, std::ostream &output);
+
+    unsigned int getThreadCount();
+
+private:
+
+    WorkStealingThreadPool pool;
+
+    std::mutex outputMutex;
+
+    static json runJob(const BatchJob &job);
+
+    static std::string formatHash(uint64_t hash);
+};
+
+#endif //MasterNostalgia_BATCHRUNNER_H
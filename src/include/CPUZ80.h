@@ -1,6 +1,7 @@
 #include <bitset>
 #include "Z80IO.h"
 #include "Utils.h"
+#include "SaveState.h"
 
 #define DEBUG_VALUES
 
@@ -72,6 +73,20 @@ public:
 
     void raisePauseInterrupt();
 
+    /**
+     * The address of the instruction which is being (or was last) executed
+     */
+    unsigned short getInstructionAddress() {
+        return originalProgramCounterValue;
+    }
+
+    /**
+     * Writes the registers, interrupt flip flops and interrupt mode, should only be called between instructions
+     */
+    void saveState(StateWriter &writer);
+
+    void loadState(StateReader &reader);
+
 private:
     typedef void (CPUZ80::*OpcodeHandler) ();
 
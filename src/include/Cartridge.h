@@ -1,12 +1,11 @@
 #ifndef CARTRIDGE_INCLUDED
 #define CARTRIDGE_INCLUDED
 
-#define MAX_CARTRIDGE_SIZE 0x400000
-
-enum CartridgeRegion {
-    Japan, USA, Europe, Unknown
-};
+#include "ROMImage.h"
 
+/**
+ * The cartridge in a machine - a view of a shared ROMImage, which can be loaded by any number of machines at once
+ */
 class Cartridge {
 public:
     Cartridge();
@@ -15,25 +14,31 @@ public:
 
     bool load(std::string fileName);
 
-    bool isCodemasters();
+    /**
+     * @return the ROM from the given offset, which can be read up to the end of its 16KB bank, or nullptr if the
+     * offset is past the end of the ROM
+     */
+    inline const unsigned char* getROM(unsigned long offset) {
+        return offset < size ? data + offset : nullptr;
+    }
 
-    unsigned char read(unsigned long location);
+    CartridgeMapper getMapper();
 
     unsigned char getBankMask();
 
-private:
-
-    bool isCodemastersCart;
+    VideoStandard getVideoStandard();
 
-    unsigned char cartridgeData[MAX_CARTRIDGE_SIZE];
+private:
 
-    void clearCartridge();
+    std::shared_ptr<const ROMImage> image;
 
-    CartridgeRegion region;
+    // Kept from the image, so that mapping banks doesn't need to go through it
+    const unsigned char *data;
 
-    void determineCartridgeSize(size_t ROMSize);
+    // The size of the ROM rounded up to a whole number of banks
+    size_t size;
 
-    unsigned char bankMask;
+    void clearCartridge();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef MasterNostalgia_CARTRIDGERAM_H
+#define MasterNostalgia_CARTRIDGERAM_H
+
+#include <string>
+#include <vector>
+
+#define CARTRIDGE_RAM_BANK_SIZE 0x4000
+#define CARTRIDGE_RAM_BANK_COUNT 2
+#define CARTRIDGE_RAM_SIZE (CARTRIDGE_RAM_BANK_SIZE * CARTRIDGE_RAM_BANK_COUNT)
+
+/**
+ * RAM on the cartridge, which games with a battery use to save. It can be kept in a save file, which is memory mapped
+ * so that every write goes straight into the file (through the OS's page cache) with nothing to flush - if the emulator
+ * crashes, the file still has every write up to that point.
+ *
+ * The save file is only created once a game first switches the RAM in, so games which never use it don't get one.
+ * Where the file can't be memory mapped, it's read when set and written back when the RAM is destroyed instead.
+ *
+ * While speculative (e.g. running ahead), the RAM is a private copy which is thrown away afterwards, so that frames
+ * which are later undone by loading a state never reach the save file.
+ */
+class CartridgeRAM {
+public:
+    CartridgeRAM();
+
+    ~CartridgeRAM();
+
+    /**
+     * Keeps the RAM in this file from now on. If the file exists it's loaded straight away. This moves the RAM, so any
+     * pointers from getBank() need fetching again.
+     */
+    void setSaveFile(const std::string &fileName);
+
+    /**
+     * Called whenever the RAM is switched in, creates the save file the first time. This can move the RAM, so
+     * getBank() must be called after this.
+     */
+    void use();
+
+    /**
+     * Switches to or from a private copy of the RAM. This moves the RAM, so getBank() must be called after this.
+     */
+    void setSpeculative(bool speculative);
+
+    unsigned char* getBank(unsigned int bank);
+
+    /**
+     * All of the banks, one after the other
+     */
+    unsigned char* getData();
+
+private:
+
+    unsigned char *data;
+
+    // Holds the RAM when it isn't mapped from the save file
+    std::vector<unsigned char> buffer;
+
+    // The copy used while speculative
+    std::vector<unsigned char> speculativeBuffer;
+
+    bool isSpeculative;
+
+    void *mappedFile;
+
+    std::string saveFileName;
+
+    bool isUsed;
+
+    /**
+     * Maps the save file in place of the buffer, creating it or extending it to the full size if needed
+     * @param copyBuffer - Whether to fill the file with the current contents of the buffer
+     */
+    bool mapFile(bool copyBuffer);
+
+    void unmapFile();
+
+    void readFile();
+
+    void writeFile();
+};
+
+#endif //MasterNostalgia_CARTRIDGERAM_H
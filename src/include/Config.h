@@ -26,8 +26,33 @@ public:
 
     bool getPreserveAspectRatio();
 
+    /**
+     * Whether to time frames from the display's refresh instead of the emulator's own timer, when the two are close enough
+     */
+    bool getSyncToDisplay();
+
     bool getPauseEmulationWhenNotInFocus();
 
+    /**
+     * How many times faster than normal to run while fast forwarding, 0 meaning as fast as possible
+     */
+    int getFastForwardSpeed();
+
+    /**
+     * How many seconds of play are kept so that they can be rewound, 0 turning rewinding off
+     */
+    int getRewindSeconds();
+
+    /**
+     * The most memory (in megabytes) used to keep the rewind history, older history is dropped to stay within this
+     */
+    int getRewindMemoryLimit();
+
+    /**
+     * The number of frames to run ahead of the real frame to reduce input lag (0 to 3), 0 turning run-ahead off
+     */
+    int getRunAheadFrames();
+
     PlayerControlConfig* getPlayer1ControlConfig();
 
     PlayerControlConfig* getPlayer2ControlConfig();
@@ -45,8 +70,18 @@ private:
 
     bool preserveAspectRatio;
 
+    bool syncToDisplay;
+
     bool pauseEmulationWhenNotInFocus;
 
+    int fastForwardSpeed;
+
+    int rewindSeconds;
+
+    int rewindMemoryLimit;
+
+    int runAheadFrames;
+
     PlayerControlConfig *player1Controls;
 
     GeneralControlConfig *generalControls;
@@ -5,14 +5,28 @@
 #ifndef MasterNostalgia_CONSOLE_H
 #define MasterNostalgia_CONSOLE_H
 
-#include <SFML/System.hpp>
-#include <SFML/Graphics.hpp>
-#include "Config.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "DebugListener.h"
+
+// The console's video output is always 256x224 RGBA, regardless of the current display mode
+#define CONSOLE_VIDEO_OUTPUT_WIDTH 256
+#define CONSOLE_VIDEO_OUTPUT_HEIGHT 224
+#define CONSOLE_VIDEO_OUTPUT_SIZE (CONSOLE_VIDEO_OUTPUT_WIDTH * CONSOLE_VIDEO_OUTPUT_HEIGHT * 4)
 
 class Console {
 public:
+    virtual ~Console() = default;
+
     virtual bool init(std::string romFilename) = 0;
 
+    /**
+     * Keeps battery backed cartridge RAM in this file, so that games' saves last between runs. Should be called after
+     * init() and before the first frame.
+     */
+    virtual void setCartridgeRAMFile(const std::string &fileName) = 0;
+
     void emulateFrame(bool hasFocus) {
 
         if (hasFocus) {
@@ -22,32 +36,123 @@ public:
         double machineClicksPerFrame = getMachineClicksPerFrame() * 2; // TODO determine why the machine runs way too slow without this multiplication - might need to revamp how timing works
         double currentClicks = 0;
 
-        while (currentClicks < machineClicksPerFrame) {
+        // Run until the video chip finishes a frame, so that every call produces exactly one new frame and frame
+        // pacing lines up with the video output. The click count is only a limit in case a frame never completes.
+        unsigned long startingFrame = getCompletedFrameCount();
+
+        while (getCompletedFrameCount() == startingFrame && currentClicks < machineClicksPerFrame * 2) {
             currentClicks += tick();
         }
+
+        finishFrame();
     };
 
     virtual bool isRunning() = 0;
 
     virtual double tick() = 0;
 
-    virtual sf::Uint8* getVideoOutput() = 0;
+    virtual uint8_t* getVideoOutput() = 0;
+
+    /**
+     * Returns the range of video output lines which have changed since the last call, so that unchanged lines don't need to be uploaded
+     * @return false if the video output has not changed
+     */
+    virtual bool consumeDirtyVideoLines(unsigned short &firstLine, unsigned short &lastLine) = 0;
 
     virtual void storeUserInput() = 0;
 
     virtual void printVDPInformation() = 0;
 
+    virtual void printAudioInformation() = 0;
+
     virtual unsigned short getCurrentDisplayWidth() = 0;
 
     virtual unsigned short getCurrentDisplayHeight() = 0;
 
-    virtual unsigned char getCurrentFrameRate() = 0;
+    /**
+     * The number of frames per second which the console outputs when running at full speed
+     */
+    virtual double getCurrentFrameRate() = 0;
+
+    /**
+     * The number of frames of video output which have been completed since the console was started
+     */
+    virtual unsigned long getCompletedFrameCount() = 0;
 
     virtual void sendPauseInterrupt() = 0;
 
+    /**
+     * Turns drawing of the video output on or off, e.g. to skip frames which won't be shown while fast forwarding
+     */
+    virtual void setVideoRenderingEnabled(bool enabled) = 0;
+
+    virtual void setAudioMuted(bool muted) = 0;
+
+    /**
+     * Marks the frames about to be run as ones which will be undone by loading an earlier state (e.g. running ahead), so
+     * that they don't change anything outside of the console such as the save file, the audio output or the debug
+     * listener. Must be turned off again before loading the state.
+     */
+    virtual void setSpeculative(bool speculative) = 0;
+
+    /**
+     * The number of bytes in a save state, which never changes for a given console so one buffer can be reused for every state
+     */
+    virtual size_t getSaveStateSize() = 0;
+
+    /**
+     * Writes the whole machine state into the buffer. This should be called between frames (after emulateFrame) as the
+     * partly drawn video output isn't included.
+     * @return the number of bytes written
+     */
+    virtual size_t saveState(uint8_t *buffer, size_t capacity) = 0;
+
+    /**
+     * Restores a state written by saveState. Throws SaveStateException if it's from a different version, is the wrong
+     * size or doesn't make sense (e.g. is for a cartridge with a different mapper), in which case the console is left
+     * in the state it was in before.
+     */
+    virtual void loadState(const uint8_t *buffer, size_t size) = 0;
+
+    /**
+     * Restores a state which this console wrote with saveState itself (e.g. run-ahead and rewind history), without
+     * keeping a copy of the current state to go back to. That copy would double the cost of every load, and isn't
+     * needed for states which can't be malformed. The header is still checked.
+     */
+    virtual void restoreState(const uint8_t *buffer, size_t size) = 0;
+
+    /**
+     * Receives watchpoint and breakpoint hits, nullptr to stop receiving them. Hits in speculative frames (see
+     * setSpeculative()) aren't reported, as those frames are undone.
+     */
+    virtual void setDebugListener(DebugListener *listener) = 0;
+
+    /**
+     * Reports reads from and/or writes to a location in the CPU's address space. Pages of memory without a watchpoint
+     * are accessed as normal, so watchpoints only slow down accesses close to them.
+     */
+    virtual void addWatchpoint(unsigned short location, bool onRead, bool onWrite) = 0;
+
+    /**
+     * Reports whenever the instruction at a location in the CPU's address space is about to be executed
+     */
+    virtual void addBreakpoint(unsigned short location) = 0;
+
+    virtual void clearDebugPoints() = 0;
+
+    /**
+     * The address of the instruction being executed, e.g. the one which hit a watchpoint
+     */
+    virtual unsigned short getInstructionAddress() = 0;
+
 protected:
 
     virtual double getMachineClicksPerFrame() = 0;
+
+    /**
+     * Called once all of the machine clicks for a frame have been emulated, for any work which is batched up until the end of a frame
+     */
+    virtual void finishFrame() = 0;
 };
 
 #endif //MasterNostalgia_CONSOLE_H
@@ -0,0 +1,23 @@
+#ifndef MasterNostalgia_DEBUGLISTENER_H
+#define MasterNostalgia_DEBUGLISTENER_H
+
+/**
+ * Told about watchpoints and breakpoints as they're hit. Calls are made in the middle of emulating an instruction, so
+ * they shouldn't change the machine's state.
+ */
+class DebugListener {
+public:
+    virtual ~DebugListener() = default;
+
+    /**
+     * @param value - The value read, or the value about to be written
+     */
+    virtual void onWatchpoint(unsigned short location, unsigned char value, bool isWrite) = 0;
+
+    /**
+     * Called before the instruction at the location is executed
+     */
+    virtual void onBreakpoint(unsigned short location) = 0;
+};
+
+#endif //MasterNostalgia_DEBUGLISTENER_H
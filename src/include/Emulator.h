@@ -2,16 +2,60 @@
 #define MasterNostalgia_EMULATOR_H
 
 #include <iostream>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include "Config.h"
 #include "Utils.h"
 #include "MasterSystem.h"
 #include "Exceptions.h"
 #include "SFML/System.hpp"
 #include "SFML/Graphics.hpp"
-#include "InputInterface.h"
+#include "KeyboardInputInterface.h"
+#include "SnapshotInputInterface.h"
+#include "SPSCRingBuffer.h"
+#include "VideoFrameExchange.h"
+#include "PSGOutputSink.h"
+#include "FramePacer.h"
+#include "RewindBuffer.h"
+#include "RunAhead.h"
+#include "InputSource.h"
+#include "InputMovie.h"
+
+// The most input messages which can be waiting for the emulation thread, it takes all of them once per frame
+#define EMULATOR_INPUT_QUEUE_SIZE 64
+
+// Frames are timed from the display's refresh (when enabled in the config) if its refresh rate is within this fraction
+// of the console's frame rate. Any small difference is absorbed by the audio's rate control.
+#define DISPLAY_SYNC_TOLERANCE 0.005
+
+// The number of presents which are measured before deciding whether the display's refresh rate is close enough
+#define DISPLAY_SYNC_MEASUREMENT_FRAMES 120
+
+/**
+ * Sent from the render thread to the emulation thread whenever the user's input or the window's focus changes
+ */
+struct EmulatorInputMessage {
+    InputSnapshot controls;
+
+    bool hasFocus;
+
+    // The console's pause button was pressed
+    bool pausePressed;
+
+    // The fast forward key is being held down
+    bool fastForward;
+
+    // The rewind key is being held down
+    bool rewind;
+};
 
 /**
  * A class for handling loading/running different systems. Right now only the Master System is supported.
+ *
+ * The console is emulated on its own thread, so that waiting for the display (vsync) or handling window events never
+ * holds up emulation. Finished frames are handed to the render thread through a VideoFrameExchange, and input is sent
+ * the other way through a ring buffer, so neither thread ever waits for the other.
  */
 class Emulator {
 public:
@@ -21,6 +65,18 @@ public:
 
     void init(const std::string &fileName);
 
+    /**
+     * Records the user's input to a movie file from power on, should be called before run(). The game's save file
+     * isn't used while recording, so that the recording doesn't depend on it.
+     */
+    void recordInput(const std::string &fileName);
+
+    /**
+     * Plays back input from a movie file from power on instead of the user's input, which takes over once the movie
+     * has finished. Should be called before run(). The game's save file isn't used, as for recordInput().
+     */
+    void replayInput(const std::string &fileName);
+
     void run();
 
 private:
@@ -30,10 +86,28 @@ private:
 
     Config *config;
 
+    PSGOutputSink *audioOutput;
+
+    // Where battery backed cartridge RAM is kept, empty if it isn't kept (e.g. while recording or replaying input)
+    std::string saveFileName;
+
+    // Recent history of the console's state for rewinding, only used on the emulation thread (nullptr if rewinding is turned off)
+    RewindBuffer *rewindBuffer;
+
+    // Runs frames ahead to reduce input lag, only used on the emulation thread (nullptr if run-ahead is turned off)
+    RunAhead *runAhead;
+
+    /**
+     * Creates whichever output the sound config asks for - live playback, a WAV file or no output
+     */
+    PSGOutputSink *createAudioOutput();
+
     void setVideoMode(unsigned int width, unsigned int height);
 
     void setRenderingTexture();
 
+    bool updateVideoOutputTexture(const VideoFrame *frame);
+
     unsigned short renderWidth;
     unsigned short renderHeight;
 
@@ -41,7 +115,82 @@ private:
 
     sf::Sprite videoOutputSprite;
 
-    InputInterface *inputInterface;
+    bool textureRequiresFullUpload;
+
+    bool redrawRequired;
+
+    KeyboardInputInterface *keyboardInput;
+
+    // What the emulated console reads its input from, only used on the emulation thread
+    SnapshotInputInterface *emulatedInput;
+
+    // The user's input, as received by the emulation thread
+    LiveInputSource *liveInput;
+
+    // Where each frame's input comes from - the user's input, a recording of it, or a replay. Only used on the emulation thread.
+    InputSource *inputSource;
+
+    SPSCRingBuffer<EmulatorInputMessage> inputMessages;
+
+    VideoFrameExchange frameExchange;
+
+    std::thread emulationThread;
+
+    std::atomic<bool> isEmulationThreadRunning;
+
+    // Set if the emulation thread stopped because of an exception, which is rethrown on the render thread
+    std::exception_ptr emulationThreadException;
+
+    std::atomic<bool> hasEmulationThreadFailed;
+
+    void runEmulationThread();
+
+    void stopEmulationThread();
+
+    /**
+     * Adds the console's current state to the rewind history
+     */
+    void recordRewindState();
+
+    /**
+     * Goes back one frame. The newest state in the history is the frame currently being shown, so this goes back two
+     * states and emulates the frame between them again to draw it - states further back are never drawn.
+     * @return true if a frame was drawn, false if there wasn't enough history left
+     */
+    bool rewindFrame();
+
+    /**
+     * Copies the console's current video output into the frame exchange for the render thread to pick up
+     */
+    void publishVideoFrame();
+
+    // The number of times the window has been presented, the emulation thread waits on this when synced to the display
+    std::atomic<unsigned long> presentCount;
+
+    // Whether the display's refresh rate is close enough to the console's frame rate to time frames from it
+    std::atomic<bool> isDisplaySynced;
+
+    // The console's frame rate, written before the emulation thread starts
+    double consoleFrameRate;
+
+    std::chrono::steady_clock::time_point lastPresentTime;
+
+    double averagePresentInterval;
+
+    unsigned int measuredPresentCount;
+
+    /**
+     * Presents the window and keeps track of how often presents (which wait for vsync) are completing, to find the
+     * display's refresh rate
+     */
+    void present();
+
+    /**
+     * Waits for the render thread to present a frame after the given present count, for syncing to the display
+     * @param frameStartTime - When the frame which was just emulated started, frames won't start closer together than
+     * slightly under the console's frame time even if presents aren't waiting for vsync
+     */
+    void waitForPresent(unsigned long previousPresentCount, std::chrono::steady_clock::time_point frameStartTime);
 };
 
-#endif
\ No newline at end of file
+#endif
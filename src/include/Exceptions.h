@@ -116,6 +116,12 @@ public:
                                                                          message) {};
 };
 
+class SaveStateException : public GeneralException {
+public:
+    explicit SaveStateException(const std::string &message) : GeneralException(std::string("Save State Exception"),
+                                                                             message) {};
+};
+
 #endif
 
 #endif //MasterNostalgia_EXCEPTIONS_H
@@ -0,0 +1,81 @@
+#ifndef MasterNostalgia_FRAMEPACER_H
+#define MasterNostalgia_FRAMEPACER_H
+
+#include <chrono>
+#include <cstdint>
+
+// Sleeping is only accurate to within a millisecond or so on most systems, so the last part of each wait is spent
+// spinning. The spin time adapts to how late sleeps actually wake up, between these limits.
+#define FRAME_PACER_MIN_SPIN_TIME_NS 500000
+#define FRAME_PACER_MAX_SPIN_TIME_NS 4000000
+
+// If this many frames late, the pacer gives up on catching up and starts counting again from the current time
+#define FRAME_PACER_MAX_FRAMES_BEHIND 2
+
+/**
+ * Keeps frames running at an exact rate (e.g. 59.922743Hz) using absolute deadlines from steady_clock, so rounding
+ * doesn't build up over time as it would when sleeping for a fixed length after each frame.
+ */
+class FramePacer {
+public:
+
+    explicit FramePacer(double frameRate);
+
+    /**
+     * Changes the rate, counting from the current time
+     */
+    void setFrameRate(double frameRate);
+
+    double getFrameRate();
+
+    /**
+     * Starts counting frames again from the current time, e.g. after emulation has been paused
+     */
+    void reset();
+
+    /**
+     * Waits until it is time for the next frame to start
+     */
+    void waitForNextFrame();
+
+    /**
+     * The average and largest amount of time that waits have finished after their deadline
+     */
+    double getAverageJitterMicroseconds();
+
+    double getMaxJitterMicroseconds();
+
+    /**
+     * The number of times the pacer fell so far behind that it gave up catching up
+     */
+    unsigned long getResyncCount();
+
+    void printDebugInfo();
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Length of a frame in picoseconds, so that the deadline of any frame can be worked out exactly from the start time
+    uint64_t framePeriodPicoseconds;
+
+    double frameRate;
+
+    Clock::time_point startTime;
+
+    uint64_t frameIndex;
+
+    Clock::duration spinTime;
+
+    uint64_t waitCount;
+
+    double totalJitterNanoseconds;
+
+    double maxJitterNanoseconds;
+
+    unsigned long resyncCount;
+
+    Clock::time_point getDeadline(uint64_t frame);
+};
+
+#endif //MasterNostalgia_FRAMEPACER_H
@@ -22,6 +22,16 @@ public:
 
     sf::Keyboard::Key getExitKey();
 
+    /**
+     * Runs the emulator faster than normal while held down
+     */
+    sf::Keyboard::Key getFastForwardKey();
+
+    /**
+     * Steps back through the recent history of play while held down
+     */
+    sf::Keyboard::Key getRewindKey();
+
 #ifdef JSON_CONFIG_FILE
 
     void setFromConfig(json generalControlKeyboardConfiguration);
@@ -36,6 +46,10 @@ private:
 
     sf::Keyboard::Key pauseKey;
 
+    sf::Keyboard::Key fastForwardKey;
+
+    sf::Keyboard::Key rewindKey;
+
 };
 
 class GeneralControlConfig {
@@ -5,8 +5,6 @@
 #ifndef MasterNostalgia_INPUTINTERFACE_H
 #define MasterNostalgia_INPUTINTERFACE_H
 
-#include "Config.h"
-
 /**
  * This class provides a standard way to determine whether the user is attempting to perform an action, regardless of what
  * the control is bound to (Keyboard/Controller/Etc)
@@ -14,26 +12,50 @@
 class InputInterface {
 public:
 
-    InputInterface(Config *config);
+    virtual ~InputInterface() = default;
+
+    virtual bool isDPadUpPressed(int port) = 0;
+
+    virtual bool isDPadDownPressed(int port) = 0;
+
+    virtual bool isDPadLeftPressed(int port) = 0;
 
-    bool isDPadUpPressed(int port);
+    virtual bool isDPadRightPressed(int port) = 0;
 
-    bool isDPadDownPressed(int port);
+    virtual bool isButtonAPressed(int port) = 0;
 
-    bool isDPadLeftPressed(int port);
+    virtual bool isButtonBPressed(int port) = 0;
+};
 
-    bool isDPadRightPressed(int port);
+/**
+ * Never reports anything as pressed, for running without any input device.
+ */
+class NullInputInterface : public InputInterface {
+public:
 
-    bool isButtonAPressed(int port);
+    bool isDPadUpPressed(int) override {
+        return false;
+    }
 
-    bool isButtonBPressed(int port);
+    bool isDPadDownPressed(int) override {
+        return false;
+    }
 
-private:
+    bool isDPadLeftPressed(int) override {
+        return false;
+    }
 
-    PlayerControlConfig *playerControls[2];
+    bool isDPadRightPressed(int) override {
+        return false;
+    }
 
-    bool isKeyboardKeyPressed(int port, PlayerControlKeyboardConfig::Actions action);
+    bool isButtonAPressed(int) override {
+        return false;
+    }
 
+    bool isButtonBPressed(int) override {
+        return false;
+    }
 };
 
 #endif //MasterNostalgia_CONTROLINTERFACE_H
@@ -0,0 +1,100 @@
+#ifndef MasterNostalgia_INPUTMOVIE_H
+#define MasterNostalgia_INPUTMOVIE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "InputSource.h"
+
+// "MNMV" when read as little endian
+#define INPUT_MOVIE_MAGIC 0x564D4E4D
+
+#define INPUT_MOVIE_VERSION 1
+
+// Magic, version and the number of frames
+#define INPUT_MOVIE_HEADER_SIZE 10
+
+// Set in a run's flags if the pause button was pressed before the first frame of the run
+#define INPUT_MOVIE_FLAG_PAUSE 0x1
+
+/**
+ * Input movies hold the input for every frame from power on, so that a run can be played back exactly.
+ *
+ * After the header, the file is a list of runs of frames which have the same input: the number of frames (7 bits per
+ * byte, with the top bit set on all but the last byte), the port DC and DD bits (see InputSnapshot::getPortBits) and a
+ * flags byte. Pause presses always start a new run. All values are little endian.
+ */
+
+/**
+ * Passes input from another source through unchanged, writing it to a movie file as it goes
+ */
+class RecordingInputSource : public InputSource {
+public:
+
+    /**
+     * @param source - Where the input comes from, owned by the caller
+     */
+    RecordingInputSource(InputSource *source, const std::string &fileName);
+
+    ~RecordingInputSource() override;
+
+    bool nextFrame(InputFrame &frame) override;
+
+    /**
+     * Writes the last run and completes the header, nothing more is recorded afterwards
+     */
+    void close();
+
+private:
+
+    InputSource *source;
+
+    std::string fileName;
+
+    std::ofstream file;
+
+    uint32_t frameCount;
+
+    uint16_t runPortBits;
+
+    uint8_t runFlags;
+
+    uint32_t runLength;
+
+    bool isClosed;
+
+    void writeRun();
+};
+
+/**
+ * Plays back a movie file, which is read into memory up front so that nothing is read from disk while running
+ */
+class ReplayInputSource : public InputSource {
+public:
+
+    explicit ReplayInputSource(const std::string &fileName);
+
+    bool nextFrame(InputFrame &frame) override;
+
+    /**
+     * The number of frames in the whole movie
+     */
+    uint32_t getFrameCount();
+
+private:
+
+    std::vector<uint8_t> data;
+
+    size_t position;
+
+    uint32_t frameCount;
+
+    InputSnapshot runControls;
+
+    uint32_t runFramesLeft;
+
+    bool isPauseLeftInRun;
+};
+
+#endif //MasterNostalgia_INPUTMOVIE_H
@@ -0,0 +1,66 @@
+#ifndef MasterNostalgia_INPUTSOURCE_H
+#define MasterNostalgia_INPUTSOURCE_H
+
+#include "SnapshotInputInterface.h"
+
+/**
+ * Everything the user does during one frame of emulation
+ */
+struct InputFrame {
+    InputSnapshot controls;
+
+    // The console's pause button was pressed before the frame
+    bool pausePressed;
+};
+
+/**
+ * Supplies the console's input one frame at a time, so that it can come from the user or a recording, and so that
+ * it can be recorded, without the console knowing the difference.
+ */
+class InputSource {
+public:
+
+    virtual ~InputSource() = default;
+
+    /**
+     * Called once before each frame is emulated
+     * @return false if there is no more input (the end of a recording), in which case the frame is left unchanged
+     */
+    virtual bool nextFrame(InputFrame &frame) = 0;
+};
+
+/**
+ * Input from the user, which is passed to this as it changes - e.g. from the messages sent by the render thread.
+ * A pause press is only given out for one frame.
+ */
+class LiveInputSource : public InputSource {
+public:
+
+    LiveInputSource() {
+        isPausePending = false;
+    }
+
+    void setControls(const InputSnapshot &controls) {
+        this->controls = controls;
+    }
+
+    void pressPause() {
+        isPausePending = true;
+    }
+
+    bool nextFrame(InputFrame &frame) override {
+        frame.controls = controls;
+        frame.pausePressed = isPausePending;
+        isPausePending = false;
+
+        return true;
+    }
+
+private:
+
+    InputSnapshot controls;
+
+    bool isPausePending;
+};
+
+#endif //MasterNostalgia_INPUTSOURCE_H
@@ -0,0 +1,35 @@
+#ifndef MasterNostalgia_KEYBOARDINPUTINTERFACE_H
+#define MasterNostalgia_KEYBOARDINPUTINTERFACE_H
+
+#include "InputInterface.h"
+#include "Config.h"
+
+/**
+ * Reads the players' controls from the keyboard using the key binds in the config
+ */
+class KeyboardInputInterface : public InputInterface {
+public:
+
+    KeyboardInputInterface(Config *config);
+
+    bool isDPadUpPressed(int port) override;
+
+    bool isDPadDownPressed(int port) override;
+
+    bool isDPadLeftPressed(int port) override;
+
+    bool isDPadRightPressed(int port) override;
+
+    bool isButtonAPressed(int port) override;
+
+    bool isButtonBPressed(int port) override;
+
+private:
+
+    PlayerControlConfig *playerControls[2];
+
+    bool isKeyboardKeyPressed(int port, PlayerControlKeyboardConfig::Actions action);
+
+};
+
+#endif //MasterNostalgia_KEYBOARDINPUTINTERFACE_H
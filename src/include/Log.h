@@ -0,0 +1,31 @@
+#ifndef MasterNostalgia_LOG_H
+#define MasterNostalgia_LOG_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+/**
+ * Where the emulation core reports what it is doing (e.g. loading a ROM) and anything that went wrong.
+ *
+ * Messages go to stdout and errors to stderr, one whole line at a time so that machines running on different threads
+ * can't interleave or change each other's stream formatting. Both can be turned off, e.g. when stdout is being used for
+ * results instead.
+ */
+class Log {
+public:
+
+    static void setEnabled(bool enabled);
+
+    static void message(const std::string &text);
+
+    static void error(const std::string &text);
+
+private:
+
+    static std::atomic<bool> enabled;
+
+    static std::mutex outputMutex;
+};
+
+#endif //MasterNostalgia_LOG_H
@@ -0,0 +1,66 @@
+#ifndef MasterNostalgia_MAPPER_H
+#define MasterNostalgia_MAPPER_H
+
+#include "Memory.h"
+
+// Every mapper's state fits in this many registers, so that save states are the same size whatever the cartridge
+#define MAPPER_REGISTER_COUNT 4
+
+/**
+ * Switches banks of a cartridge's ROM (and RAM) into the Z80's address space. Mappers never see reads - when one of
+ * their registers is written to, they update Memory's page table to match.
+ *
+ * To add a mapper, add it to CartridgeMapper, implement the three functions below and add it to Mapper::create().
+ */
+class Mapper {
+public:
+
+    static Mapper* create(CartridgeMapper type, Memory *memory, Cartridge *cartridge);
+
+    Mapper(CartridgeMapper type, Memory *memory, Cartridge *cartridge);
+
+    virtual ~Mapper() = default;
+
+    /**
+     * Sets the registers to their power on values, tells Memory where they are and maps in the starting banks
+     */
+    virtual void reset() = 0;
+
+    /**
+     * Called for every write to the addresses passed to Memory::setMapperRegisters()
+     */
+    virtual void write(unsigned short location, unsigned char value) = 0;
+
+    /**
+     * Maps in the banks selected by the registers
+     */
+    virtual void updatePages() = 0;
+
+    /**
+     * Writes the mapper type (checked when loading, as a state can only be loaded with the same type of cartridge) and its registers
+     */
+    void saveState(StateWriter &writer);
+
+    /**
+     * The pages aren't updated, as they can depend on other state - updatePages() needs calling once everything is loaded
+     */
+    void loadState(StateReader &reader);
+
+protected:
+
+    CartridgeMapper type;
+
+    Memory *memory;
+
+    Cartridge *cartridge;
+
+    unsigned char registers[MAPPER_REGISTER_COUNT];
+
+    /**
+     * Where a bank starts in the ROM, with the bank number wrapped to the size of the cartridge
+     * @param bankSize - The size of the mapper's banks, 0x4000 or 0x2000
+     */
+    unsigned long getBankOffset(unsigned char bank, unsigned int bankSize);
+};
+
+#endif //MasterNostalgia_MAPPER_H
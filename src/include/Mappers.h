@@ -0,0 +1,78 @@
+#ifndef MasterNostalgia_MAPPERS_H
+#define MasterNostalgia_MAPPERS_H
+
+#include "Mapper.h"
+
+/**
+ * The standard mapper. Registers at 0xFFFC-0xFFFF (which are also RAM) select the 16KB banks at 0x0000 (apart from
+ * the first 1KB, which is always bank 0), 0x4000 and 0x8000, and 0xFFFC can switch cartridge RAM in at 0x8000.
+ */
+class SegaMapper : public Mapper {
+public:
+    SegaMapper(Memory *memory, Cartridge *cartridge);
+
+    void reset() override;
+
+    void write(unsigned short location, unsigned char value) override;
+
+    void updatePages() override;
+};
+
+/**
+ * Used by Codemasters games. Writes to 0x0000, 0x4000 and 0x8000 select the 16KB bank at that address.
+ */
+class CodemastersMapper : public Mapper {
+public:
+    CodemastersMapper(Memory *memory, Cartridge *cartridge);
+
+    void reset() override;
+
+    void write(unsigned short location, unsigned char value) override;
+
+    void updatePages() override;
+};
+
+/**
+ * Used by some Korean games. The first 32KB is fixed, and writes to 0xA000 select the 16KB bank at 0x8000.
+ */
+class KoreanMapper : public Mapper {
+public:
+    KoreanMapper(Memory *memory, Cartridge *cartridge);
+
+    void reset() override;
+
+    void write(unsigned short location, unsigned char value) override;
+
+    void updatePages() override;
+};
+
+/**
+ * Used by Korean conversions of MSX games. The first 16KB is fixed, and writes to 0x0000-0x0003 select the 8KB banks
+ * at 0x8000, 0xA000, 0x4000 and 0x6000 respectively.
+ */
+class KoreanMSXMapper : public Mapper {
+public:
+    KoreanMSXMapper(Memory *memory, Cartridge *cartridge);
+
+    void reset() override;
+
+    void write(unsigned short location, unsigned char value) override;
+
+    void updatePages() override;
+};
+
+/**
+ * For ROMs of up to 48KB with no mapper, which are simply mapped in from 0x0000 to 0xBFFF.
+ */
+class NoMapper : public Mapper {
+public:
+    NoMapper(Memory *memory, Cartridge *cartridge);
+
+    void reset() override;
+
+    void write(unsigned short location, unsigned char value) override;
+
+    void updatePages() override;
+};
+
+#endif //MasterNostalgia_MAPPERS_H
@@ -1,3 +1,4 @@
+#include <vector>
 #include "Cartridge.h"
 #include "Memory.h"
 #include "CPUZ80.h"
@@ -8,32 +9,74 @@
 #include "MasterSystemInput.h"
 #include "MasterSystemZ80IO.h"
 
+// Master clocks (53.693175Mhz / 15 * 3 for NTSC, 53.203424Mhz / 15 * 3 for PAL) and the number of master clock cycles
+// in a frame (684 per scanline), which give frame rates of 59.922743Hz and 49.701459Hz.
+#define MASTER_SYSTEM_NTSC_MASTER_CLOCK 10738635.0
+#define MASTER_SYSTEM_NTSC_CLICKS_PER_FRAME (684 * 262)
+#define MASTER_SYSTEM_PAL_MASTER_CLOCK 10640684.8
+#define MASTER_SYSTEM_PAL_CLICKS_PER_FRAME (684 * 313)
+
 class MasterSystem final : public Console {
 public:
-    MasterSystem(InputInterface *inputInterface, Config *config);
+    /**
+     * @param audioOutput - Where the PSG's samples are sent, owned by the caller and must outlive the machine
+     */
+    MasterSystem(InputInterface *inputInterface, SoundConfig *soundConfig, PSGOutputSink *audioOutput);
 
     ~MasterSystem();
 
     bool init(std::string romFilename) final;
 
+    void setCartridgeRAMFile(const std::string &fileName) final;
+
     double tick();
 
     bool isRunning() final;
 
-    sf::Uint8* getVideoOutput() final;
+    uint8_t* getVideoOutput() final;
+
+    bool consumeDirtyVideoLines(unsigned short &firstLine, unsigned short &lastLine) final;
 
     void storeUserInput() final;
 
     void printVDPInformation() final;
 
+    void printAudioInformation() final;
+
     unsigned short getCurrentDisplayWidth() final;
 
     unsigned short getCurrentDisplayHeight() final;
 
-    unsigned char getCurrentFrameRate() final;
+    double getCurrentFrameRate() final;
+
+    unsigned long getCompletedFrameCount() final;
 
     void sendPauseInterrupt() final;
 
+    void setVideoRenderingEnabled(bool enabled) final;
+
+    void setAudioMuted(bool muted) final;
+
+    void setSpeculative(bool speculative) final;
+
+    size_t getSaveStateSize() final;
+
+    size_t saveState(uint8_t *buffer, size_t capacity) final;
+
+    void loadState(const uint8_t *buffer, size_t size) final;
+
+    void restoreState(const uint8_t *buffer, size_t size) final;
+
+    void setDebugListener(DebugListener *listener) final;
+
+    void addWatchpoint(unsigned short location, bool onRead, bool onWrite) final;
+
+    void addBreakpoint(unsigned short location) final;
+
+    void clearDebugPoints() final;
+
+    unsigned short getInstructionAddress() final;
+
 private:
     CPUZ80 *smsCPU;
     Memory *smsMemory;
@@ -42,9 +85,29 @@ private:
     PSG *smsPSG;
     MasterSystemInput *smsInput;
     MasterSystemZ80IO *z80Io;
-    Config *config;
     bool running;
+
+    size_t saveStateSize;
+
+    // The state before the one being loaded, which is put back if loading fails
+    std::vector<uint8_t> loadBackup;
+
+    double getCPUCyclesPerSecond();
+
+    void writeState(StateWriter &writer);
+
+    /**
+     * Checks that the state is one this machine can load, before anything is changed
+     */
+    void readHeader(StateReader &reader, size_t size);
+
+    /**
+     * Loads every component's state, which starts after the header
+     */
+    void readState(StateReader &reader);
 protected:
 
     double getMachineClicksPerFrame() final;
+
+    void finishFrame() final;
 };
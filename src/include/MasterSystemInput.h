@@ -7,6 +7,7 @@
 
 #include "MasterSystemController.h"
 #include "InputInterface.h"
+#include "SaveState.h"
 
 class MasterSystemInput {
 public:
@@ -19,11 +20,17 @@ public:
 
     unsigned char readPortDD();
 
+    /**
+     * Writes the button states latched by the last call to setState()
+     */
+    void saveState(StateWriter &writer);
+
+    void loadState(StateReader &reader);
+
 private:
     InputInterface *inputInterface;
     MasterSystemController controllers[2];
     unsigned char resetButton;
-    unsigned char pauseButton;
 };
 
 #endif //MasterNostalgia_MASTERSYSTEMINPUT_H
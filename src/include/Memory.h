@@ -1,6 +1,20 @@
 #ifndef MEMORY_INCLUDED
 #define MEMORY_INCLUDED
 
+#include "SaveState.h"
+#include "Cartridge.h"
+#include <bitset>
+#include "CartridgeRAM.h"
+#include "DebugListener.h"
+
+// The address space is split into 1KB pages, the smallest unit that anything is ever mapped in
+#define MEMORY_PAGE_SHIFT 10
+#define MEMORY_PAGE_SIZE (1 << MEMORY_PAGE_SHIFT)
+#define MEMORY_PAGE_MASK (MEMORY_PAGE_SIZE - 1)
+#define MEMORY_PAGE_COUNT (0x10000 / MEMORY_PAGE_SIZE)
+
+class Mapper;
+
 enum MemoryControlRegisterFlags : int{
     unknown0 = 0,
     unknown1 = 1,
@@ -12,35 +26,177 @@ enum MemoryControlRegisterFlags : int{
     enableExpansionSlot = 7
 };
 
+// The console has 8KB of RAM, which appears twice from 0xC000
+#define MEMORY_RAM_SIZE 0x2000
+
+// Accesses to pages with any of these set are checked more closely, going through Memory::readFlaggedPage() or
+// writeFlaggedPage() rather than straight to memory where needed, so that pages without any cost nothing extra
+enum MemoryPageFlags : unsigned char {
+    MemoryPageMapperRegisters = 1 << 0,
+    MemoryPageWatched = 1 << 1
+};
+
+/**
+ * The Z80's address space. Every read and write goes through a table of pages, so the same simple lookup is used
+ * whichever mapper the cartridge has - the mapper only changes the table when one of its bank registers is written to.
+ */
 class Memory {
 public:
     Memory(Cartridge *cart);
 
     ~Memory();
 
-    unsigned char read(unsigned short location);
+    /**
+     * Creates the mapper for the loaded cartridge and maps in its starting banks, must be called once the cartridge is loaded
+     */
+    void initMapper();
+
+    inline unsigned char read(unsigned short location) {
+        unsigned int page = location >> MEMORY_PAGE_SHIFT;
+
+        if (readFlags[page] != 0) {
+            return readFlaggedPage(location);
+        }
+
+        return readPages[page][location & MEMORY_PAGE_MASK];
+    }
 
     unsigned short read16Bit(unsigned short location);
 
-    void write(unsigned short location, unsigned char value);
+    inline void write(unsigned short location, unsigned char value) {
+        unsigned int page = location >> MEMORY_PAGE_SHIFT;
+
+        // Only the flagged addresses themselves take the slow path, the rest of their page is written to directly
+        if (writeFlags[page] != 0 && writeFlaggedLocations[location]) {
+            writeFlaggedPage(location, value);
+            return;
+        }
+
+        writePages[page][location & MEMORY_PAGE_MASK] = value;
+    }
 
     void write(unsigned short location, unsigned short value);
 
     void writeMediaControlRegister(unsigned char value);
 
+    /**
+     * Maps part of the ROM in, reading as 0xFF if the cartridge slot is disabled, or 0 past the end of the ROM. Writes
+     * to it are ignored.
+     * @param location - Where to map it to, a multiple of the page size
+     * @param length - The number of bytes to map, a multiple of the page size
+     * @param romOffset - Where in the ROM to map from
+     */
+    void mapROM(unsigned short location, unsigned int length, unsigned long romOffset);
+
+    /**
+     * Maps one of the cartridge's 16KB RAM banks in, for reading and writing
+     */
+    void mapCartridgeRAM(unsigned short location, unsigned int length, unsigned int bank);
+
+    /**
+     * Keeps the cartridge RAM in this file, see CartridgeRAM
+     */
+    void setCartridgeRAMFile(const std::string &fileName);
+
+    /**
+     * See Console::setSpeculative()
+     */
+    void setSpeculative(bool speculative);
+
+    /**
+     * Sends writes to these addresses to the mapper. Other writes to the same pages (e.g. RAM at 0xFC00-0xFFFB with the
+     * Sega mapper) still go straight to memory, after checking writeFlaggedLocations.
+     */
+    void setMapperRegisters(unsigned short location, unsigned int length);
+
+    void setDebugListener(DebugListener *listener);
+
+    /**
+     * Tells the debug listener whenever the location is read from and/or written to
+     */
+    void addWatchpoint(unsigned short location, bool onRead, bool onWrite);
+
+    /**
+     * Tells the debug listener whenever the instruction at the location is about to be executed
+     */
+    void addBreakpoint(unsigned short location);
+
+    void clearDebugPoints();
+
+    /**
+     * Whether any breakpoints are set at all, so that the CPU can skip looking up the page of every instruction
+     */
+    inline bool hasBreakpoints() {
+        return hasAnyBreakpoints;
+    }
+
+    /**
+     * Whether there's a breakpoint anywhere in the location's page - checkBreakpoint() only needs calling if so
+     */
+    inline bool isBreakpointPage(unsigned short location) {
+        return breakpointPages[location >> MEMORY_PAGE_SHIFT];
+    }
+
+    void checkBreakpoint(unsigned short location);
+
+    /**
+     * Writes the system RAM, cartridge RAM banks, mapper registers and the media control register
+     */
+    void saveState(StateWriter &writer);
+
+    void loadState(StateReader &reader);
+
 private:
     Cartridge *smsCartridge;
-    unsigned char ram[0x10000]{};
-    bool ramBanked; // Does cartridge include additional RAM?
-    void handleMemoryPaging(unsigned short location, unsigned char value);
+    Mapper *mapper;
+    unsigned char ram[MEMORY_RAM_SIZE]{};
 
-    unsigned char ramBank[2][0x4000]{};
-    int currentPage3RamBank;
-    unsigned short memoryPages[3]{};
+    CartridgeRAM cartridgeRAM;
 
     unsigned char controlRegister;
 
-    unsigned char readMedia(unsigned long location);
+    const unsigned char *readPages[MEMORY_PAGE_COUNT];
+
+    unsigned char *writePages[MEMORY_PAGE_COUNT];
+
+    unsigned char readFlags[MEMORY_PAGE_COUNT];
+
+    unsigned char writeFlags[MEMORY_PAGE_COUNT];
+
+    bool breakpointPages[MEMORY_PAGE_COUNT];
+
+    bool hasAnyBreakpoints;
+
+    DebugListener *debugListener;
+
+    // The debug listener isn't told about anything while speculative
+    bool isSpeculative;
+
+    std::bitset<0x10000> readWatchpoints;
+
+    std::bitset<0x10000> writeWatchpoints;
+
+    std::bitset<0x10000> breakpoints;
+
+    std::bitset<0x10000> mapperRegisters;
+
+    // Mapper registers and write watchpoints, as pages are too coarse to tell which writes need writeFlaggedPage()
+    std::bitset<0x10000> writeFlaggedLocations;
+
+    // Where writes to ROM go, so that they can be stored like any other write
+    unsigned char discardPage[MEMORY_PAGE_SIZE];
+
+    bool isCartridgeSlotEnabled();
+
+    /**
+     * Handles reads from watched pages
+     */
+    unsigned char readFlaggedPage(unsigned short location);
+
+    /**
+     * Handles writes to mapper registers and watched pages
+     */
+    void writeFlaggedPage(unsigned short location, unsigned char value);
 };
 
 #endif
\ No newline at end of file
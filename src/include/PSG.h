@@ -1,17 +1,21 @@
 #ifndef SMS_PSG_H
 #define SMS_PSG_H
 
-#define BUFFER_SIZE 4096
-#define SAMPLE_RATE 44100
+#define BUFFER_SIZE 512
 
-// 3.3Mhz / 16
-// TODO should this be 223720 ((machine clock/3)/16)? Do a comparison and determine which sounds more correct.
-#define PSG_CLOCK_SPEED 220000
+// 3.58Mhz / 16 ((machine clock/3)/16)
+#define PSG_CLOCK_SPEED 223722
+
+// The most that the output rate can be adjusted by to keep the audio stream's buffer at its target level (0.5%)
+#define RATE_CONTROL_MAX_ADJUSTMENT 0.005
 
 #include "PSGChannel.h"
 #include "SoundConfig.h"
-#include <SFML/Audio.hpp>
-#include <bitset>
+#include "PSGOutputSink.h"
+#include "BandLimitedBuffer.h"
+
+// The noise channel's shift register is reset to this whenever the noise register is written to
+#define NOISE_SHIFT_REGISTER_RESET 0x8000
 
 enum PSGChannelIndex {
     Tone0 = 0,
@@ -22,40 +26,145 @@ enum PSGChannelIndex {
 
 class PSG {
 public:
-    PSG(SoundConfig *soundConfig);
+    /**
+     * @param soundConfig
+     * @param cpuClockRate - The number of CPU cycles which will be passed to addCycles() for each second of emulation
+     * @param outputSink - Where generated samples are sent, this is owned by the caller and must outlive the PSG
+     */
+    PSG(SoundConfig *soundConfig, double cpuClockRate, PSGOutputSink *outputSink);
 
     ~PSG();
 
-    void execute(float soundCycles);
+    /**
+     * Changes the number of CPU cycles per second (e.g. for a PAL console), throwing away anything not yet synthesized.
+     * Should be called before the first frame.
+     */
+    void setClockRate(double cpuClockRate);
+
+    /**
+     * Moves the PSG's clock forward. Nothing is synthesized here - the output is only worked out when a register is
+     * written to or the frame ends, so this is cheap enough to call after every instruction.
+     */
+    inline void addCycles(unsigned int cpuCycles) {
+        blockTime += cpuCycles;
+    }
 
     void write(unsigned char data);
 
+    /**
+     * Synthesizes everything up to the current time and sends it for playback, should be called at the end of each frame
+     */
+    void endFrame();
+
+    void printDebugInfo();
+
+    /**
+     * While muted, everything is still emulated but the generated samples are thrown away (e.g. while fast forwarding)
+     */
+    void setMuted(bool muted);
+
+    /**
+     * While speculative, nothing is synthesized at all, as the frames being run will be undone by loading a state. The
+     * synth isn't part of the state, so this leaves it exactly where it was for the real frames which follow.
+     */
+    void setSpeculative(bool speculative);
+
+    /**
+     * The average number of samples waiting to be played (only tracked for real-time output), which rate control tries to keep at the audio stream's target fill level
+     */
+    double getAverageFillLevel();
+
+    /**
+     * The current adjustment to the number of samples generated per second, 1.0 being no adjustment
+     */
+    double getRateAdjustment();
+
+    /**
+     * Writes the registers, channel timing and noise shift register. Synthesized samples and rate control aren't part
+     * of the state - they belong to the audio output rather than the emulated machine.
+     */
+    void saveState(StateWriter &writer);
+
+    /**
+     * Any difference between the current and the loaded output is recorded as a normal change in amplitude, so the
+     * output carries straight on from whatever has been played so far instead of jumping or clicking
+     */
+    void loadState(StateReader &reader);
+
 private:
     PSGChannel *channels[4];
     unsigned short volumeTable[16];
     unsigned char selectedRegister;
     bool hasSelectedVolumeRegister;
 
-    float cycles;
-    unsigned long int clockInfo;
+    // Number of CPU cycles per PSG clock, each tone channel's counter is decremented once per PSG clock
+    unsigned int clockDivider;
 
-    sf::Int16 buffer[BUFFER_SIZE];
+    // CPU cycles since the start of the current block of samples
+    unsigned int blockTime;
 
-    unsigned long currentBufferLocation;
+    // The time within the current block which channel output has been synthesized up to
+    unsigned int synthesizedTime;
 
-    void playBuffer();
-    void clearBuffer();
+    // The largest number of CPU cycles in a block, longer periods of time are split up so that the synth buffer can't overflow
+    unsigned int blockLength;
 
-    sf::SoundBuffer *outputBuffer;
-    sf::Sound *outputSound;
-    float bufferUpdateLimit ;
-    float currentBufferUpdates;
+    int16_t buffer[BUFFER_SIZE];
 
-    inline bool getParity(unsigned short value) {
-        return std::bitset<4>(value).count() % 2 == 0;
-    }
+    BandLimitedBuffer *synth;
+
+    PSGOutputSink *outputSink;
+
+    double averageFillLevel;
+
+    double rateAdjustment;
+
+    bool isMuted;
+
+    bool isSpeculative;
+
+    bool isSynthesizing();
+
+    /**
+     * Emulation and audio playback run from different clocks (and the emulation speed isn't exact), so the output buffer
+     * would slowly drain or overflow. This nudges the output rate up or down by a fraction of a percent based on how
+     * full the buffer is, which is too small to be heard but keeps playback continuous.
+     */
+    void updateRateControl();
+
+    unsigned short noiseShiftRegister;
+
+    /**
+     * For each possible value of the low byte of the noise shift register, how many shifts it will take for the
+     * output bit (bit 0) to change, counting up to the end of that byte.
+     */
+    unsigned char noiseRunLengths[256];
+
+    void generateNoiseRunLengths();
+
+    unsigned int getNoiseRunLength();
+
+    void shiftNoise(unsigned int shifts);
+
+    unsigned int getNoiseShiftPeriod();
+
+    /**
+     * Records every change in each channel's output which happens before the given time
+     */
+    void runChannels(unsigned int endTime);
+
+    void runTone(PSGChannel *channel, unsigned int endTime);
+
+    void runNoise(unsigned int endTime);
+
+    void updateAmplitude(PSGChannel *channel, unsigned int time);
+
+    /**
+     * Brings the output of every channel up to the current time
+     */
+    void synthesize();
 
-    unsigned short emulateTone(float floor, int channelNumber);
+    void endBlock(unsigned int length);
 
     SoundConfig *soundConfig;
 };
@@ -0,0 +1,64 @@
+#ifndef MasterNostalgia_PSGAUDIOSTREAM_H
+#define MasterNostalgia_PSGAUDIOSTREAM_H
+
+#include <atomic>
+#include <vector>
+#include <SFML/Audio.hpp>
+#include "SPSCRingBuffer.h"
+#include "PSGOutputSink.h"
+
+// How much audio the PSG's rate control tries to keep buffered, playback starts once this much is available.
+// The chunk and ring buffer sizes are worked out from this, so that latency is the same at any sample rate.
+#define AUDIO_STREAM_TARGET_LATENCY_MS 46
+
+/**
+ * Continuously plays the samples generated by the PSG. The emulation thread writes samples into a ring buffer,
+ * which SFML's audio thread then pulls from whenever it needs more data.
+ */
+class PSGAudioStream : public sf::SoundStream, public PSGOutputSink {
+public:
+
+    PSGAudioStream(unsigned int sampleRate);
+
+    ~PSGAudioStream() override;
+
+    /**
+     * Queues samples for playback, any samples which don't fit in the buffer are dropped and counted as an overrun.
+     */
+    void write(const int16_t *samples, size_t count) override;
+
+    bool isRealTime() override;
+
+    size_t getFillLevel() override;
+
+    size_t getTargetFillLevel() override;
+
+    void printDebugInfo() override;
+
+    unsigned long getUnderrunCount();
+
+    unsigned long getOverrunCount();
+
+private:
+
+    bool onGetData(Chunk &data) override;
+
+    void onSeek(sf::Time) override;
+
+    // Must be declared before the ring buffer, which is sized from it
+    size_t targetFillLevel;
+
+    SPSCRingBuffer<sf::Int16> ringBuffer;
+
+    std::vector<sf::Int16> chunk;
+
+    sf::Int16 lastSample;
+
+    bool isStarted;
+
+    std::atomic<unsigned long> underrunCount;
+
+    std::atomic<unsigned long> overrunCount;
+};
+
+#endif //MasterNostalgia_PSGAUDIOSTREAM_H
@@ -5,7 +5,7 @@
 #ifndef MasterNostalgia_PSGCHANNEL_H
 #define MasterNostalgia_PSGCHANNEL_H
 
-#include <SFML/System.hpp>
+#include "SaveState.h"
 
 class PSGChannel {
 public:
@@ -21,10 +21,21 @@ public:
 
     void setFrequencyLower(unsigned char value);
 
-    int counter{};
+    void saveState(StateWriter &writer);
+
+    /**
+     * Loads the registers and timing, the amplitude is left for the PSG to update so that it can record the change
+     */
+    void loadState(StateReader &reader);
+
+    // CPU clock time at which the output will next change polarity, relative to the start of the PSG's current block
+    unsigned int nextTransitionTime;
 
     int polarity;
 
+    // The amplitude which this channel is currently outputting
+    int amplitude;
+
 private:
 
     unsigned char volume;
@@ -0,0 +1,95 @@
+#ifndef MasterNostalgia_PSGOUTPUTSINK_H
+#define MasterNostalgia_PSGOUTPUTSINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Utils.h"
+
+/**
+ * Somewhere for the PSG to send the samples it generates - live playback, a file, or nowhere.
+ */
+class PSGOutputSink {
+public:
+
+    virtual ~PSGOutputSink() = default;
+
+    virtual void write(const int16_t *samples, size_t count) = 0;
+
+    /**
+     * Whether samples are consumed by a clock other than the emulator's (e.g. an audio device). Only real-time sinks
+     * have the output rate adjusted to keep their buffer level steady, so that the output of other sinks depends only
+     * on what was emulated.
+     */
+    virtual bool isRealTime() = 0;
+
+    /**
+     * The number of samples currently waiting to be consumed, only meaningful for real-time sinks
+     */
+    virtual size_t getFillLevel() {
+        return 0;
+    }
+
+    /**
+     * The number of samples which should be kept waiting to be consumed, only meaningful for real-time sinks
+     */
+    virtual size_t getTargetFillLevel() {
+        return 0;
+    }
+
+    virtual void printDebugInfo() {}
+};
+
+/**
+ * Discards everything, for running without any audio output.
+ */
+class PSGNullOutputSink : public PSGOutputSink {
+public:
+
+    void write(const int16_t *, size_t) override {}
+
+    bool isRealTime() override {
+        return false;
+    }
+};
+
+/**
+ * Keeps a hash of every sample written, so that the audio from two runs can be compared without storing it
+ */
+class PSGHashOutputSink : public PSGOutputSink {
+public:
+
+    PSGHashOutputSink() {
+        hash = Utils::fnv1aHash(nullptr, 0);
+        sampleCount = 0;
+    }
+
+    void write(const int16_t *samples, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            // Little endian, so that the hash is the same on every host
+            const uint8_t bytes[2] = {(uint8_t)(samples[i] & 0xFF), (uint8_t)((uint16_t)samples[i] >> 8)};
+            hash = Utils::fnv1aHash(bytes, 2, hash);
+        }
+
+        sampleCount += count;
+    }
+
+    bool isRealTime() override {
+        return false;
+    }
+
+    uint64_t getHash() {
+        return hash;
+    }
+
+    unsigned long long getSampleCount() {
+        return sampleCount;
+    }
+
+private:
+
+    uint64_t hash;
+
+    unsigned long long sampleCount;
+};
+
+#endif //MasterNostalgia_PSGOUTPUTSINK_H
@@ -0,0 +1,85 @@
+#ifndef MasterNostalgia_PSGWAVEFILEWRITER_H
+#define MasterNostalgia_PSGWAVEFILEWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PSGOutputSink.h"
+
+// Samples are collected into blocks of this many bytes before being handed to the writer thread
+#define WAVE_WRITER_BLOCK_SIZE (256 * 1024)
+
+// The most blocks which can be waiting to be written, write() waits for the writer thread when this many are queued
+#define WAVE_WRITER_MAX_QUEUED_BLOCKS 8
+
+#define WAVE_HEADER_SIZE 44
+
+/**
+ * Writes the PSG's output to a 16-bit mono PCM WAV file, or to a raw file of the same samples with no header.
+ *
+ * The file is written on a background thread in large blocks so that the emulation thread never waits on disk I/O.
+ * Samples are always stored little-endian and the header's sizes are filled in when the file is closed, so the
+ * file's contents depend only on the samples written.
+ */
+class PSGWaveFileWriter : public PSGOutputSink {
+public:
+
+    /**
+     * @param isRaw - Write only the samples (16-bit little-endian mono), without the WAV header
+     */
+    PSGWaveFileWriter(const std::string &fileName, unsigned int sampleRate, bool isRaw);
+
+    ~PSGWaveFileWriter() override;
+
+    void write(const int16_t *samples, size_t count) override;
+
+    bool isRealTime() override;
+
+    void printDebugInfo() override;
+
+    /**
+     * Writes any remaining samples and completes the file's header, nothing can be written afterwards
+     */
+    void close();
+
+private:
+
+    std::string fileName;
+
+    std::ofstream file;
+
+    bool isRaw;
+
+    // Block which write() is currently filling
+    std::vector<char> pendingBlock;
+
+    // Blocks waiting for the writer thread
+    std::deque<std::vector<char>> queuedBlocks;
+
+    std::mutex queueMutex;
+
+    std::condition_variable queueChanged;
+
+    std::thread writerThread;
+
+    bool isClosing;
+
+    bool isClosed;
+
+    std::atomic<bool> hasWriteFailed;
+
+    unsigned long long dataSize;
+
+    void writeHeader(unsigned int sampleRate);
+
+    void submitPendingBlock();
+
+    void runWriterThread();
+};
+
+#endif //MasterNostalgia_PSGWAVEFILEWRITER_H
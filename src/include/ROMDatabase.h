@@ -0,0 +1,51 @@
+#ifndef MasterNostalgia_ROMDATABASE_H
+#define MasterNostalgia_ROMDATABASE_H
+
+#include <cstddef>
+#include <cstdint>
+
+enum CartridgeRegion {
+    Japan, USA, Europe, Korea, Unknown
+};
+
+// How ROM banks are switched into the Z80's address space
+enum CartridgeMapper : uint8_t {
+    MapperNone,
+    MapperSega,
+    MapperCodemasters,
+    MapperKorean,
+    MapperKoreanMSX
+};
+
+enum VideoStandard : uint8_t {
+    VideoStandardNTSC,
+    VideoStandardPAL
+};
+
+struct ROMDatabaseEntry {
+    uint32_t crc;
+
+    const char *name;
+
+    CartridgeMapper mapper;
+
+    CartridgeRegion region;
+
+    VideoStandard videoStandard;
+};
+
+/**
+ * Games which can't be run correctly from what's in the ROM alone (their mapper, or needing PAL timing), keyed by the
+ * CRC-32 of the ROM without any copier header. The entries are kept in a sorted array so that they're built into the
+ * executable as they are, with nothing to set up at runtime.
+ */
+class ROMDatabase {
+public:
+
+    /**
+     * @return the entry for the ROM with this CRC, or nullptr if it isn't known
+     */
+    static const ROMDatabaseEntry* find(uint32_t crc);
+};
+
+#endif //MasterNostalgia_ROMDATABASE_H
@@ -0,0 +1,144 @@
+#ifndef MasterNostalgia_ROMIMAGE_H
+#define MasterNostalgia_ROMIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ROMDatabase.h"
+
+#define MAX_CARTRIDGE_SIZE 0x400000
+
+#define ROM_BANK_SIZE 0x4000
+
+// Some ROM dumps start with a header added by the copier used to make them, which isn't part of the ROM
+#define COPIER_HEADER_SIZE 512
+
+/**
+ * The contents of a ROM file and what's known about it - from the ROM database if it's listed there, otherwise worked
+ * out from its header. Images never change once loaded, so every
+ * machine which loads the same file shares one image - only the ROM's real size is stored, and it's freed once the last
+ * machine using it is gone.
+ *
+ * Where possible the file is memory mapped rather than read, so loading is close to free and only the parts of the ROM
+ * which are actually run take up memory.
+ */
+class ROMImage {
+public:
+
+    /**
+     * Returns the already loaded image for this file if there is one (and the file hasn't changed since), or loads it
+     * @return the image, or nullptr if the file couldn't be loaded
+     */
+    static std::shared_ptr<const ROMImage> load(const std::string &fileName);
+
+    ~ROMImage();
+
+    const unsigned char* getData() const;
+
+    /**
+     * The size of the ROM, not including any copier header
+     */
+    size_t getSize() const;
+
+    /**
+     * The number of 16KB banks in the ROM - the data can be read up to the end of the last bank, which is padded with 0
+     * if the ROM doesn't fill it
+     */
+    size_t getBankCount() const;
+
+    /**
+     * The CRC-32 of the ROM, not including any copier header
+     */
+    uint32_t getCRC32() const;
+
+    /**
+     * The game's name if it's in the ROM database, otherwise empty
+     */
+    const std::string& getName() const;
+
+    CartridgeMapper getMapper() const;
+
+    bool isCodemasters() const;
+
+    unsigned char getBankMask() const;
+
+    CartridgeRegion getRegion() const;
+
+    VideoStandard getVideoStandard() const;
+
+private:
+
+    ROMImage();
+
+    // The whole file, including any copier header
+    const unsigned char *fileData;
+
+    size_t fileDataSize;
+
+    // Where the ROM starts within the file
+    size_t headerOffset;
+
+    // Set if the file is memory mapped, otherwise it's read into fileContents
+    void *mappedFile;
+
+    std::vector<unsigned char> fileContents;
+
+    uint32_t crc;
+
+    std::string name;
+
+    CartridgeMapper mapper;
+
+    unsigned char bankMask;
+
+    CartridgeRegion region;
+
+    VideoStandard videoStandard;
+
+    // Used to tell whether the file has changed since it was loaded
+    int64_t fileSize;
+
+    time_t fileModifiedTime;
+
+    /**
+     * Maps or reads the ROM from the file, and records what's needed to tell whether the file changes later
+     */
+    bool loadFile(const std::string &fileName);
+
+    /**
+     * Whether this image and the other one were loaded from the same version of a file
+     */
+    bool isSameFile(const ROMImage &other) const;
+
+#ifndef _WIN32
+    bool mapFile(int fileDescriptor, size_t size);
+
+    bool readFile(int fileDescriptor, size_t size);
+#endif
+
+    /**
+     * Works out the cartridge type, region and size from the ROM, only looking at whatever parts of it are present
+     */
+    void parseHeader();
+
+    /**
+     * Replaces anything guessed from the header with the ROM database's entry, if there is one
+     */
+    void applyDatabaseEntry();
+
+    bool hasBytesAt(size_t location, size_t length) const;
+
+    void determineCartridgeSize(size_t ROMSize);
+
+    static std::mutex registryMutex;
+
+    // Images which are currently loaded, by file name. Entries for images which have been freed are removed on the next load
+    static std::map<std::string, std::weak_ptr<const ROMImage>> registry;
+};
+
+#endif //MasterNostalgia_ROMIMAGE_H
@@ -0,0 +1,114 @@
+#ifndef MasterNostalgia_REWINDBUFFER_H
+#define MasterNostalgia_REWINDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Unchanged runs shorter than this are left inside a literal, as a new run costs more than it saves
+#define REWIND_MIN_UNCHANGED_RUN 8
+
+/**
+ * Keeps a history of save states so that play can be stepped backwards one frame at a time.
+ *
+ * Only the newest state is kept whole. Every older state is stored as a backward delta - the newer state XORed with
+ * the older one, with runs of unchanged (zero) bytes removed - as most of the machine doesn't change from one frame to
+ * the next. The deltas are kept in a ring of memory which is allocated up front, and the oldest are dropped when it
+ * (or the limit on the number of states) is full, so nothing is allocated while running.
+ */
+class RewindBuffer {
+public:
+
+    /**
+     * @param stateSize - The size of every state, see Console::getSaveStateSize()
+     * @param memoryLimit - The number of bytes to keep deltas in
+     * @param maxStates - The most states to keep, e.g. the number of frames in the length of time to keep
+     */
+    RewindBuffer(size_t stateSize, size_t memoryLimit, size_t maxStates);
+
+    /**
+     * Where the next state should be written before calling push(), so that it doesn't need to be copied
+     */
+    uint8_t* getWriteBuffer();
+
+    /**
+     * Adds the state in the write buffer as the newest state
+     */
+    void push();
+
+    /**
+     * Drops the newest state, so that the one before it becomes the newest
+     * @return the state before the newest one, or nullptr if there are no older states (in which case nothing is dropped)
+     */
+    const uint8_t* stepBack();
+
+    /**
+     * The number of states which stepBack() can go back through
+     */
+    size_t getAvailableSteps();
+
+    void clear();
+
+    void printDebugInfo();
+
+private:
+
+    struct Delta {
+        size_t offset;
+
+        size_t length;
+    };
+
+    size_t stateSize;
+
+    std::vector<uint8_t> newestState;
+
+    bool hasNewestState;
+
+    std::vector<uint8_t> writeBuffer;
+
+    // Large enough for the worst case encoding of a delta
+    std::vector<uint8_t> encodeBuffer;
+
+    std::vector<uint8_t> deltaMemory;
+
+    // Ring of the stored deltas, oldest first
+    std::vector<Delta> deltas;
+
+    size_t firstDelta;
+
+    size_t deltaCount;
+
+    unsigned long pushCount;
+
+    unsigned long droppedCount;
+
+    double averageDeltaLength;
+
+    double averagePushTime;
+
+    /**
+     * Writes the XOR of the two states as a series of (unchanged byte count, changed byte count, changed bytes) runs
+     * @return the length of the encoded delta
+     */
+    size_t encodeDelta(const uint8_t *newer, const uint8_t *older, uint8_t *output);
+
+    /**
+     * XORs an encoded delta into a state, turning the newer state into the older one
+     */
+    void applyDelta(const uint8_t *delta, size_t length, uint8_t *state);
+
+    /**
+     * Finds room in the delta memory for a delta of the given length, dropping the oldest deltas until it fits
+     * @return the offset to store the delta at
+     */
+    size_t allocate(size_t length);
+
+    void dropOldest();
+
+    static uint8_t* writeLength(uint8_t *output, size_t value);
+
+    static const uint8_t* readLength(const uint8_t *input, size_t &value);
+};
+
+#endif //MasterNostalgia_REWINDBUFFER_H
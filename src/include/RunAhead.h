@@ -0,0 +1,53 @@
+#ifndef MasterNostalgia_RUNAHEAD_H
+#define MasterNostalgia_RUNAHEAD_H
+
+#include <cstdint>
+#include <vector>
+#include "Console.h"
+
+#define RUN_AHEAD_MAX_FRAMES 3
+
+/**
+ * Hides some of the delay between input and the game reacting to it. Most games only read the controls once per frame
+ * and take another frame or two to show the result, so after each real frame this saves the console's state, runs a
+ * few frames further with the same input, shows the last of those frames, and then loads the saved state again.
+ *
+ * Only the final frame that is run ahead is drawn. The frames run ahead don't synthesize any sound and their writes to
+ * cartridge RAM are thrown away (see Console::setSpeculative()). This costs up to (frames + 1) times as much emulation
+ * per frame, plus a save and a load.
+ */
+class RunAhead {
+public:
+
+    /**
+     * @param console - The console to run, which must have been initialised
+     * @param frames - The number of frames to run ahead, from 1 to RUN_AHEAD_MAX_FRAMES
+     */
+    RunAhead(Console *console, unsigned int frames);
+
+    /**
+     * Emulates the next real frame, then leaves the console's video output showing the frame which is the given number
+     * of frames ahead.
+     */
+    void emulateFrame(bool hasFocus);
+
+    /**
+     * The average number of seconds per frame spent running ahead (the frames run ahead, saving and loading)
+     */
+    double getAverageCost();
+
+    void printDebugInfo();
+
+private:
+    Console *console;
+
+    unsigned int frames;
+
+    std::vector<uint8_t> state;
+
+    double totalCost;
+
+    unsigned long frameCount;
+};
+
+#endif //MasterNostalgia_RUNAHEAD_H
@@ -0,0 +1,109 @@
+#ifndef MasterNostalgia_SPSCRINGBUFFER_H
+#define MasterNostalgia_SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * A lock-free ring buffer which allows exactly one thread to write to it and one (other) thread to read from it
+ * at the same time. The capacity is rounded up to a power of two so that indexes can be wrapped with a mask.
+ */
+template <typename T>
+class SPSCRingBuffer {
+public:
+
+    explicit SPSCRingBuffer(size_t minimumCapacity) {
+        size_t capacity = 1;
+
+        while (capacity < minimumCapacity) {
+            capacity <<= 1;
+        }
+
+        data.resize(capacity);
+        mask = capacity - 1;
+        readIndex = 0;
+        writeIndex = 0;
+    }
+
+    /**
+     * Copies as many of the given items into the buffer as will fit - should only be called from the producer thread
+     * @return the number of items which were written
+     */
+    size_t push(const T *items, size_t count) {
+        size_t write = writeIndex.load(std::memory_order_relaxed);
+        size_t read = readIndex.load(std::memory_order_acquire);
+
+        size_t space = data.size() - (write - read);
+
+        if (count > space) {
+            count = space;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            data[(write + i) & mask] = items[i];
+        }
+
+        writeIndex.store(write + count, std::memory_order_release);
+
+        return count;
+    }
+
+    bool push(const T &item) {
+        return push(&item, 1) == 1;
+    }
+
+    /**
+     * Moves up to count items out of the buffer - should only be called from the consumer thread
+     * @return the number of items which were read
+     */
+    size_t pop(T *items, size_t count) {
+        size_t read = readIndex.load(std::memory_order_relaxed);
+        size_t write = writeIndex.load(std::memory_order_acquire);
+
+        size_t available = write - read;
+
+        if (count > available) {
+            count = available;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            items[i] = data[(read + i) & mask];
+        }
+
+        readIndex.store(read + count, std::memory_order_release);
+
+        return count;
+    }
+
+    bool pop(T &item) {
+        return pop(&item, 1) == 1;
+    }
+
+    /**
+     * The number of items currently waiting to be read, this is only a snapshot if called while the other thread is active.
+     */
+    size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return data.size();
+    }
+
+private:
+    std::vector<T> data;
+
+    size_t mask;
+
+    // Padded onto separate cache lines so that the producer and consumer don't keep invalidating each other's cache
+    char readIndexPadding[64];
+
+    std::atomic<size_t> readIndex;
+
+    char writeIndexPadding[64];
+
+    std::atomic<size_t> writeIndex;
+};
+
+#endif //MasterNostalgia_SPSCRINGBUFFER_H
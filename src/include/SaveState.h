@@ -0,0 +1,221 @@
+#ifndef MasterNostalgia_SAVESTATE_H
+#define MasterNostalgia_SAVESTATE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "Exceptions.h"
+
+// "MNSS" when read as little endian
+#define SAVE_STATE_MAGIC 0x53534E4D
+
+// Must be increased whenever the layout of any component's state changes, older states are then rejected
+#define SAVE_STATE_VERSION 3
+
+// Each component's state starts with one of these, so that a state which doesn't line up is caught straight away
+enum SaveStateSection : uint8_t {
+    SaveStateCPU = 1,
+    SaveStateMemory = 2,
+    SaveStateVDP = 3,
+    SaveStatePSG = 4,
+    SaveStateInput = 5
+};
+
+/**
+ * Writes machine state into a caller owned buffer. Every value has a fixed size and position (there are no field
+ * names or per-field tags), and multi-byte values are always little endian so that states can be moved between hosts.
+ *
+ * If constructed without a buffer, nothing is written and only the size is counted - used to work out how large a
+ * buffer needs to be.
+ */
+class StateWriter {
+public:
+
+    StateWriter(uint8_t *buffer, size_t capacity) {
+        this->buffer = buffer;
+        this->capacity = capacity;
+        position = 0;
+    }
+
+    void beginSection(SaveStateSection section) {
+        writeByte(section);
+    }
+
+    void writeByte(uint8_t value) {
+        uint8_t *destination = reserve(1);
+
+        if (destination != nullptr) {
+            destination[0] = value;
+        }
+    }
+
+    void writeBool(bool value) {
+        writeByte(value ? 1 : 0);
+    }
+
+    void writeWord(uint16_t value) {
+        uint8_t *destination = reserve(2);
+
+        if (destination != nullptr) {
+            destination[0] = (uint8_t)value;
+            destination[1] = (uint8_t)(value >> 8);
+        }
+    }
+
+    void writeLong(uint32_t value) {
+        uint8_t *destination = reserve(4);
+
+        if (destination != nullptr) {
+            for (int i = 0; i < 4; i++) {
+                destination[i] = (uint8_t)(value >> (i * 8));
+            }
+        }
+    }
+
+    void writeQuad(uint64_t value) {
+        uint8_t *destination = reserve(8);
+
+        if (destination != nullptr) {
+            for (int i = 0; i < 8; i++) {
+                destination[i] = (uint8_t)(value >> (i * 8));
+            }
+        }
+    }
+
+    void writeBlock(const uint8_t *data, size_t length) {
+        uint8_t *destination = reserve(length);
+
+        if (destination != nullptr) {
+            std::memcpy(destination, data, length);
+        }
+    }
+
+    size_t getSize() {
+        return position;
+    }
+
+private:
+    uint8_t *buffer;
+
+    size_t capacity;
+
+    size_t position;
+
+    uint8_t* reserve(size_t length) {
+        if (buffer == nullptr) {
+            position += length;
+            return nullptr;
+        }
+
+        if (length > capacity - position) {
+            throw SaveStateException("Save state buffer is too small (" + std::to_string(capacity) + " bytes)");
+        }
+
+        uint8_t *destination = buffer + position;
+        position += length;
+
+        return destination;
+    }
+};
+
+/**
+ * Reads back state written by StateWriter, throwing SaveStateException if the data runs out or a section is out of place
+ */
+class StateReader {
+public:
+
+    StateReader(const uint8_t *buffer, size_t size) {
+        this->buffer = buffer;
+        this->size = size;
+        position = 0;
+    }
+
+    void beginSection(SaveStateSection section) {
+        if (readByte() != section) {
+            throw SaveStateException("Section " + std::to_string(section) + " was not found at offset " + std::to_string(position - 1));
+        }
+    }
+
+    uint8_t readByte() {
+        return *consume(1);
+    }
+
+    bool readBool() {
+        return readByte() != 0;
+    }
+
+    uint16_t readWord() {
+        const uint8_t *source = consume(2);
+
+        return (uint16_t)(source[0] | (source[1] << 8));
+    }
+
+    uint32_t readLong() {
+        const uint8_t *source = consume(4);
+        uint32_t value = 0;
+
+        for (int i = 0; i < 4; i++) {
+            value |= (uint32_t)source[i] << (i * 8);
+        }
+
+        return value;
+    }
+
+    uint64_t readQuad() {
+        const uint8_t *source = consume(8);
+        uint64_t value = 0;
+
+        for (int i = 0; i < 8; i++) {
+            value |= (uint64_t)source[i] << (i * 8);
+        }
+
+        return value;
+    }
+
+    void readBlock(uint8_t *data, size_t length) {
+        std::memcpy(data, consume(length), length);
+    }
+
+    /**
+     * The same as readBlock, but only writes the parts of the block which differ from the state. Used for memory which
+     * is mapped from a file, where a write marks the page as changed even if it writes the same value.
+     */
+    void readChangedBlock(uint8_t *data, size_t length) {
+        const uint8_t *source = consume(length);
+        const size_t chunkSize = 64;
+
+        for (size_t offset = 0; offset < length; offset += chunkSize) {
+            size_t chunkLength = std::min(chunkSize, length - offset);
+
+            if (std::memcmp(data + offset, source + offset, chunkLength) != 0) {
+                std::memcpy(data + offset, source + offset, chunkLength);
+            }
+        }
+    }
+
+    size_t getPosition() {
+        return position;
+    }
+
+private:
+    const uint8_t *buffer;
+
+    size_t size;
+
+    size_t position;
+
+    const uint8_t* consume(size_t length) {
+        if (length > size - position) {
+            throw SaveStateException("Save state ended unexpectedly at offset " + std::to_string(position));
+        }
+
+        const uint8_t *source = buffer + position;
+        position += length;
+
+        return source;
+    }
+};
+
+#endif //MasterNostalgia_SAVESTATE_H
@@ -0,0 +1,110 @@
+#ifndef MasterNostalgia_SNAPSHOTINPUTINTERFACE_H
+#define MasterNostalgia_SNAPSHOTINPUTINTERFACE_H
+
+#include <cstdint>
+#include <cstring>
+#include "InputInterface.h"
+#include "MasterSystemController.h"
+
+/**
+ * The state of both players' controls at one point in time, small enough to be copied between threads
+ */
+struct InputSnapshot {
+    bool buttons[2][6];
+
+    InputSnapshot() {
+        memset(buttons, 0, sizeof(buttons));
+    }
+
+    static InputSnapshot capture(InputInterface *source) {
+        InputSnapshot snapshot;
+
+        for (int port = 0; port < 2; port++) {
+            snapshot.buttons[port][MasterSystemControllerButton::dPadUp] = source->isDPadUpPressed(port);
+            snapshot.buttons[port][MasterSystemControllerButton::dPadDown] = source->isDPadDownPressed(port);
+            snapshot.buttons[port][MasterSystemControllerButton::dPadLeft] = source->isDPadLeftPressed(port);
+            snapshot.buttons[port][MasterSystemControllerButton::dPadRight] = source->isDPadRightPressed(port);
+            snapshot.buttons[port][MasterSystemControllerButton::buttonA] = source->isButtonAPressed(port);
+            snapshot.buttons[port][MasterSystemControllerButton::buttonB] = source->isButtonBPressed(port);
+        }
+
+        return snapshot;
+    }
+
+    /**
+     * Packs the buttons in the same order as the controller ports read them - port DC in the low byte (player 1, then
+     * player 2's up and down) and port DD in the high byte (the rest of player 2). Pressed buttons are 1 here, although
+     * the ports themselves read 0 for a pressed button.
+     */
+    uint16_t getPortBits() const {
+        uint16_t bits = 0;
+
+        for (int button = 0; button < 6; button++) {
+            bits |= (uint16_t)((buttons[0][button] ? 1 : 0) << button);
+            bits |= (uint16_t)((buttons[1][button] ? 1 : 0) << (button + 6));
+        }
+
+        return bits;
+    }
+
+    static InputSnapshot fromPortBits(uint16_t bits) {
+        InputSnapshot snapshot;
+
+        for (int button = 0; button < 6; button++) {
+            snapshot.buttons[0][button] = (bits >> button) & 1;
+            snapshot.buttons[1][button] = (bits >> (button + 6)) & 1;
+        }
+
+        return snapshot;
+    }
+
+    bool operator==(const InputSnapshot &other) const {
+        return memcmp(buttons, other.buttons, sizeof(buttons)) == 0;
+    }
+
+    bool operator!=(const InputSnapshot &other) const {
+        return !(*this == other);
+    }
+};
+
+/**
+ * Reports whatever was in the last snapshot it was given, so that the emulated machine can read input which was
+ * captured on another thread.
+ */
+class SnapshotInputInterface : public InputInterface {
+public:
+
+    void setSnapshot(const InputSnapshot &snapshot) {
+        this->snapshot = snapshot;
+    }
+
+    bool isDPadUpPressed(int port) override {
+        return snapshot.buttons[port][MasterSystemControllerButton::dPadUp];
+    }
+
+    bool isDPadDownPressed(int port) override {
+        return snapshot.buttons[port][MasterSystemControllerButton::dPadDown];
+    }
+
+    bool isDPadLeftPressed(int port) override {
+        return snapshot.buttons[port][MasterSystemControllerButton::dPadLeft];
+    }
+
+    bool isDPadRightPressed(int port) override {
+        return snapshot.buttons[port][MasterSystemControllerButton::dPadRight];
+    }
+
+    bool isButtonAPressed(int port) override {
+        return snapshot.buttons[port][MasterSystemControllerButton::buttonA];
+    }
+
+    bool isButtonBPressed(int port) override {
+        return snapshot.buttons[port][MasterSystemControllerButton::buttonB];
+    }
+
+private:
+
+    InputSnapshot snapshot;
+};
+
+#endif //MasterNostalgia_SNAPSHOTINPUTINTERFACE_H
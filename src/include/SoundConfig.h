@@ -1,8 +1,20 @@
 #ifndef MasterNostalgia_SOUNDCONFIG_H
 #define MasterNostalgia_SOUNDCONFIG_H
 
+#include <string>
 #include "JsonHandler.hpp"
 
+#define SOUND_DEFAULT_SAMPLE_RATE 44100
+#define SOUND_MIN_SAMPLE_RATE 22050
+#define SOUND_MAX_SAMPLE_RATE 192000
+
+enum SoundOutputType {
+    Playback,
+    WaveFile,
+    RawFile,
+    NoOutput
+};
+
 class SoundConfig {
 public:
     SoundConfig();
@@ -18,10 +30,25 @@ public:
 
     int getVolume();
 
+    unsigned int getSampleRate();
+
+    SoundOutputType getOutputType();
+
+    /**
+     * The file which audio is written to when the output type is WaveFile or RawFile
+     */
+    std::string getOutputFileName();
+
 private:
     bool enabled;
 
     int volume;
+
+    unsigned int sampleRate;
+
+    SoundOutputType outputType;
+
+    std::string outputFileName;
 };
 
 #endif //MasterNostalgia_SOUNDCONFIG_H
@@ -2,6 +2,8 @@
 #define UTILS_INCLUDED
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 #include <iomanip>
 #include <ctime>
 
@@ -54,6 +56,10 @@ public:
 
     static std::string formatHexNumber(unsigned char value);
 
+    static uint64_t fnv1aHash(const uint8_t *data, size_t length, uint64_t hash = 0xCBF29CE484222325ULL);
+
+    static uint32_t crc32(const uint8_t *data, size_t length, uint32_t crc = 0);
+
 private:
 };
 
@@ -2,8 +2,9 @@
 #define SMS_VDP_H
 
 #include "VDPDisplayMode.h"
-#include <SFML/System.hpp>
-#include <SFML/Graphics.hpp>
+#include "SaveState.h"
+#include "ROMDatabase.h"
+#include <cstdint>
 
 struct Mode2Colour {
     Mode2Colour(unsigned char r, unsigned char g, unsigned char b) {
@@ -45,14 +46,48 @@ public:
 
     unsigned char readVCounter();
 
-    sf::Uint8* getVideoOutput();
+    uint8_t* getVideoOutput();
+
+    /**
+     * Returns the range of lines in the video output which have changed since this was last called
+     * @param firstLine
+     * @param lastLine
+     * @return false if nothing has changed
+     */
+    bool consumeDirtyLines(unsigned short &firstLine, unsigned short &lastLine);
 
     bool isRequestingInterrupt();
 
+    /**
+     * The number of frames which have been completed since power on
+     */
+    unsigned long getFrameCount();
+
+    /**
+     * Stops drawing the background and updating the video output (e.g. while fast forwarding, for frames which won't be
+     * shown). Sprites are still processed so that the collision and overflow flags are unaffected. Takes effect from
+     * the start of the next frame, so a frame is never only partly drawn.
+     */
+    void setRenderingEnabled(bool enabled);
+
+    /**
+     * PAL consoles have 313 scanlines per frame rather than 262, with the VCounter jumping back at a different point
+     * to make up the difference. Should be set before the first frame.
+     */
+    void setVideoStandard(VideoStandard standard);
+
     void printDebugInfo();
 
     VDPDisplayMode getDisplayMode();
 
+    /**
+     * Writes VRAM, CRAM, the registers, counters and latches. The video output isn't included, so a state should be
+     * taken between frames - otherwise the part of the frame drawn before it was taken is missing after loading.
+     */
+    void saveState(StateWriter &writer);
+
+    void loadState(StateReader &reader);
+
 private:
 
     /**
@@ -112,12 +147,21 @@ private:
 
     VDPDisplayMode displayMode;
 
+    VideoStandard videoStandard;
+
+    /**
+     * Switches to the display mode with the given number of active lines for the current video standard
+     */
+    void setDisplayMode(unsigned char activeDisplayEnd);
+
     void handleScanlineChange();
 
     unsigned char lineInterruptCounter;
 
     unsigned char vCounterJumpCount;
 
+    unsigned long frameCount;
+
     unsigned short getSpriteAllocationTableBaseAddress();
 
     void renderSpritesMode2();
@@ -132,14 +176,25 @@ private:
 
     //region Display output
     // TODO these could probably do with refactoring once multiple systems are supported. Might be useful to have a separate "display" class.
-    sf::Uint8 *workingBuffer;
+    uint8_t *workingBuffer;
 
-    sf::Uint8 *outputBuffer;
+    uint8_t *outputBuffer;
 
     void clearScreen();
 
     void fillVideoOutput();
 
+    bool hasDirtyLines;
+
+    unsigned short dirtyLineStart;
+
+    unsigned short dirtyLineEnd;
+
+    bool isRenderingEnabled;
+
+    // Whether the current frame is being drawn, as isRenderingEnabled only takes effect at the start of a frame
+    bool isRenderingFrame;
+
     void putPixel(unsigned long index, unsigned char r, unsigned char g, unsigned char b);
 
     bool isPixelUsed(unsigned long index);
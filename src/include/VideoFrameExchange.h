@@ -0,0 +1,74 @@
+#ifndef MasterNostalgia_VIDEOFRAMEEXCHANGE_H
+#define MasterNostalgia_VIDEOFRAMEEXCHANGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A finished frame of video output, along with which lines have changed since the last frame that was taken by the reader
+ */
+struct VideoFrame {
+    std::vector<uint8_t> pixels;
+
+    unsigned short width;
+
+    unsigned short height;
+
+    bool hasDirtyLines;
+
+    unsigned short firstDirtyLine;
+
+    unsigned short lastDirtyLine;
+
+    void markDirty(unsigned short firstLine, unsigned short lastLine);
+};
+
+/**
+ * Passes finished frames from the emulation thread to the render thread without either of them waiting on a lock
+ * (a triple buffer). The writer always has a frame of its own to fill, the reader always has a frame of its own to
+ * display, and the third frame holds the newest one which has been published but not taken yet.
+ *
+ * If the writer publishes again before the reader takes the previous frame, that frame is never seen - so its dirty
+ * lines are carried over into the new frame, and the reader can still upload only the lines which have changed.
+ */
+class VideoFrameExchange {
+public:
+
+    explicit VideoFrameExchange(size_t frameSize);
+
+    /**
+     * The frame which the writer should fill next - its dirty lines are cleared when it is handed over
+     */
+    VideoFrame *getWriteFrame();
+
+    /**
+     * Makes the write frame available to the reader, replacing any frame which it hasn't taken yet
+     */
+    void publish();
+
+    /**
+     * Takes the newest published frame, which belongs to the reader until the next call
+     * @return nullptr if nothing has been published since the last call
+     */
+    VideoFrame *acquireLatest();
+
+private:
+
+    // The low two bits of the state hold the index of the frame in the middle, this bit is set when it hasn't been taken yet
+    static const unsigned int FRAME_UNREAD = 0x4;
+    static const unsigned int FRAME_INDEX_MASK = 0x3;
+
+    VideoFrame frames[3];
+
+    std::atomic<unsigned int> state;
+
+    // Only used by the writer
+    unsigned int writeIndex;
+
+    // Only used by the reader
+    unsigned int readIndex;
+};
+
+#endif //MasterNostalgia_VIDEOFRAMEEXCHANGE_H
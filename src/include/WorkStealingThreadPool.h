@@ -0,0 +1,53 @@
+#ifndef MasterNostalgia_WORKSTEALINGTHREADPOOL_H
+#define MasterNostalgia_WORKSTEALINGTHREADPOOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * Runs a fixed set of independent tasks across a number of threads.
+ *
+ * The tasks are shared out evenly between the threads' own queues at the start. Each thread works through its own queue
+ * from the back, and once that's empty it steals from the front of another thread's queue, so a thread which is given a
+ * few slow tasks doesn't hold everything up while the others sit idle. Tasks are expected to be large (e.g. running a
+ * whole ROM), so each queue simply has its own lock.
+ */
+class WorkStealingThreadPool {
+public:
+
+    /**
+     * @param threadCount - The number of threads to run tasks on, 0 meaning one per CPU core
+     */
+    explicit WorkStealingThreadPool(unsigned int threadCount);
+
+    unsigned int getThreadCount();
+
+    /**
+     * Calls task once for each index from 0 to taskCount - 1, and returns once every call has finished. The task must
+     * not throw, and may be called from any of the threads at the same time.
+     */
+    void run(size_t taskCount, const std::function<void(size_t)> &task);
+
+private:
+
+    struct WorkerQueue {
+        std::mutex mutex;
+
+        std::deque<size_t> tasks;
+    };
+
+    unsigned int threadCount;
+
+    std::vector<WorkerQueue> queues;
+
+    void runWorker(unsigned int worker, const std::function<void(size_t)> &task);
+
+    bool popOwnTask(unsigned int worker, size_t &task);
+
+    bool stealTask(unsigned int worker, size_t &task);
+};
+
+#endif //MasterNostalgia_WORKSTEALINGTHREADPOOL_H
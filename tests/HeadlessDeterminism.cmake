@@ -0,0 +1,65 @@
+# Runs a small generated ROM through the headless build several times, failing unless every run gives the same final
+# frame and audio. Running ahead must not change either: with run-ahead the final frame shown is the one that many
+# frames further on, and the audio is the same as without it.
+#
+# Usage: cmake -DHEADLESS=<MasterNostalgiaHeadless> -DWORK_DIR=<directory> -P HeadlessDeterminism.cmake
+
+set(FRAMES 120)
+set(RUN_AHEAD_FRAMES 2)
+
+# Turns the display and tone 0 on, then loops forever writing an increasing value to colour 0 and tone 0's volume.
+# None of the bytes are 0 (which a CMake string can't hold), and the rest of the bank is padded with 0 when loaded.
+string(ASCII
+        243 49 240 223
+        62 143 211 127 62 16 211 127
+        62 64 211 191 62 129 211 191
+        175 211 191 62 192 211 191
+        4 120 211 190
+        230 15 246 144 211 127
+        24 237
+        ROM_DATA)
+
+set(ROM "${WORK_DIR}/determinism.sms")
+file(WRITE "${ROM}" "${ROM_DATA}")
+
+# Sets <name>_FRAME to the final frame's hash and <name>_AUDIO to the hash of the WAV output
+function(run_headless name frames)
+    set(wav "${WORK_DIR}/${name}.wav")
+
+    execute_process(
+            COMMAND "${HEADLESS}" "${ROM}" -frames ${frames} -wav "${wav}" ${ARGN}
+            OUTPUT_VARIABLE output
+            RESULT_VARIABLE result)
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${name} run failed (${result}):\n${output}")
+    endif()
+
+    string(REGEX MATCH "Frame hash: ([0-9a-f]+)" match "${output}")
+
+    if (NOT match)
+        message(FATAL_ERROR "${name} run didn't report a frame hash:\n${output}")
+    endif()
+
+    file(SHA256 "${wav}" audioHash)
+    set(${name}_FRAME "${CMAKE_MATCH_1}" PARENT_SCOPE)
+    set(${name}_AUDIO "${audioHash}" PARENT_SCOPE)
+endfunction()
+
+function(expect_equal description first second)
+    if (NOT "${first}" STREQUAL "${second}")
+        message(FATAL_ERROR "${description} differ: ${first} and ${second}")
+    endif()
+endfunction()
+
+math(EXPR FRAMES_AHEAD "${FRAMES} + ${RUN_AHEAD_FRAMES}")
+
+run_headless(first ${FRAMES})
+run_headless(second ${FRAMES})
+run_headless(ahead ${FRAMES} -run-ahead ${RUN_AHEAD_FRAMES})
+run_headless(later ${FRAMES_AHEAD})
+
+expect_equal("Frame hashes of identical runs" "${first_FRAME}" "${second_FRAME}")
+expect_equal("Audio of identical runs" "${first_AUDIO}" "${second_AUDIO}")
+expect_equal("Frame hashes with run-ahead and of the frame run ahead to" "${ahead_FRAME}" "${later_FRAME}")
+expect_equal("Audio with and without run-ahead" "${ahead_AUDIO}" "${first_AUDIO}")